@@ -1,7 +1,10 @@
 #include <cstdlib>
+#include <future>
 #include <iostream>
 #include <hexicord/gateway_client.hpp>
+#include <hexicord/models.hpp>
 #include <hexicord/rest_client.hpp>
+#include <hexicord/snowflake_map.hpp>
 
 int main(int argc, char** argv) {
     const char* botToken = std::getenv("BOT_TOKEN");
@@ -21,25 +24,26 @@ int main(int argc, char** argv) {
     Hexicord::GatewayClient gclient(ioService, botToken);
     Hexicord::RestClient    rclient(ioService, botToken);
 
-    std::map<Hexicord::Snowflake, bool> switchFlags;;
-    nlohmann::json me;
+    Hexicord::SnowflakeMap<bool> switchFlags;
+    Hexicord::Snowflake meId;
 
-    gclient.eventDispatcher.addHandler(Hexicord::Event::Ready, [&me](const nlohmann::json& json) {
-        me = json["user"];
+    gclient.eventDispatcher.addHandler(Hexicord::Event::Ready, [&meId](const nlohmann::json& json) {
+        meId = json["user"]["id"].get<Hexicord::Snowflake>();
     });
 
-    gclient.eventDispatcher.addHandler(Hexicord::Event::MessageCreate, [&](const nlohmann::json& json) {
-        Hexicord::Snowflake messageId(json["id"].get<std::string>());
-        Hexicord::Snowflake channelId(json["channel_id"].get<std::string>());
+    // Typed handler: message is decoded straight from JSON text, without nlohmann::json.
+    gclient.eventDispatcher.addTypedHandler<Hexicord::Message>(Hexicord::Event::MessageCreate,
+                                                               [&](const Hexicord::Message& message) {
+        Hexicord::Snowflake messageId = message.id;
+        Hexicord::Snowflake channelId = message.channelId;
 
         // Sender can be webhook. For such we need to use "webhook_id" instead of "id".
-        Hexicord::Snowflake senderId(json["author"].count("id") ? json["author"]["id"].get<std::string>()
-                                                                : json["author"]["webhook_id"].get<std::string>());
+        Hexicord::Snowflake senderId = message.author.id ? message.author.id : message.webhookId;
 
         // Avoid responing to messages of bot.
-        if (senderId == Hexicord::Snowflake(me["id"].get<std::string>())) return;
+        if (senderId == meId) return;
 
-        std::string text = json["content"];
+        const std::string& text = message.content;
         
         std::string messageInfo = 
             std::string("Message ID: `") + std::to_string(messageId) + 
@@ -49,12 +53,7 @@ int main(int argc, char** argv) {
 
         std::cout << messageInfo;
 
-        auto it = switchFlags.find(channelId);
-        if (it == switchFlags.end()) { 
-            switchFlags.emplace(channelId, false);
-            it = switchFlags.find(channelId);
-        }
-        bool& switchFlag = it->second;
+        bool& switchFlag = switchFlags.emplace(channelId, false).first->second;
 
         if (text == "echo-bot turn-on") {
             if (switchFlag) {
@@ -94,6 +93,10 @@ int main(int argc, char** argv) {
         }
     });
 
+    // Open REST connections in background while gateway handshake is
+    // performed, so first reply doesn't wait for DNS, TCP and TLS.
+    std::future<void> restWarmup = rclient.prewarm();
+
     // Connect to gateway (getGatewayUrlBot returns pair, where first is gateway URL).
     // We also set status to "Playing echo-bot turn-on".
     gclient.connect(rclient.getGatewayUrlBot().first,
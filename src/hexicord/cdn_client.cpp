@@ -0,0 +1,180 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/cdn_client.hpp"
+
+#include <utility>                                    // std::move
+#include <boost/asio/io_service.hpp>                  // boost::asio::io_service
+#include <boost/asio/error.hpp>                       // boost::asio::error
+#include <boost/beast/http/error.hpp>                 // boost::beast::http::error
+#include "hexicord/config.hpp"                        // HEXICORD_DEBUG_LOG
+#include "hexicord/exceptions.hpp"                    // Hexicord::LogicError
+#include "hexicord/internal/rest.hpp"                 // Hexicord::REST
+#include "hexicord/internal/request_scheduler.hpp"    // Hexicord::RequestScheduler
+#include "hexicord/internal/resolver.hpp"             // Hexicord::DNS
+#include "hexicord/internal/utils.hpp"                // Hexicord::Utils::split
+#include "hexicord/internal/worker_pool.hpp"          // Hexicord::WorkerPool
+
+#ifdef HEXICORD_DEBUG_LOG
+    #include <iostream>
+    #define DEBUG_MSG(msg) do { std::cerr << "cdn_client.cpp:" << __LINE__ << "\t" << (msg) << '\n'; } while (false)
+#else
+    #define DEBUG_MSG(msg)
+#endif
+
+namespace Hexicord {
+    namespace {
+        // Owns CdnClient shared by users of io_service, so it's destroyed
+        // together with io_service and never outlives it.
+        class CdnService : public boost::asio::io_service::service {
+        public:
+            static boost::asio::io_service::id id;
+
+            explicit CdnService(boost::asio::io_service& ioService)
+                : boost::asio::io_service::service(ioService)
+                , client(ioService) {}
+
+            CdnClient client;
+        private:
+            void shutdown_service() override {}
+        };
+
+        boost::asio::io_service::id CdnService::id;
+    } // namespace
+
+    CdnClient::CdnClient(boost::asio::io_service& ioService, unsigned connectionsCount)
+        : connectionsCount(connectionsCount)
+        , ioService(ioService)
+        , scheduler(new RequestScheduler(connectionsCount, { 1 })) {
+
+        for (unsigned i = 0; i < connectionsCount; ++i) {
+            connections.emplace_back(new REST::HTTPSConnection(ioService, serverName));
+        }
+
+        DNS::prefetch(ioService, serverName, 443);
+    }
+
+    CdnClient::~CdnClient() {
+        // Join workers explicitly, tasks use other members.
+        workers.reset();
+    }
+
+    std::vector<uint8_t> CdnClient::download(const std::string& path) {
+        REST::HTTPRequest request;
+        request.method  = "GET";
+        request.path    = path;
+        request.version = 11;
+
+        REST::HTTPResponse response;
+        {
+            RequestScheduler::Turn turn(*scheduler, 0);
+            std::shared_ptr<REST::HTTPSConnection>& connection = connections[turn.slot];
+
+            for (unsigned attempt = 0;; ++attempt) {
+                try {
+                    if (!connection->isOpen()) connection->open();
+                    response = connection->request(request);
+                    break;
+                } catch (boost::system::system_error& excp) {
+                    // Connection state is unknown after error, don't reuse it.
+                    connection.reset(new REST::HTTPSConnection(ioService, serverName));
+
+                    // Keep-alive connection may be closed by server at any moment,
+                    // retry once in this case.
+                    bool closedByRemote = excp.code() == boost::beast::http::error::end_of_stream ||
+                                          excp.code() == boost::asio::error::broken_pipe ||
+                                          excp.code() == boost::asio::error::connection_reset;
+                    if (attempt != 0 || !closedByRemote) throw;
+
+                    DEBUG_MSG("CDN connection closed by remote. Reopenning and retrying.");
+                }
+            }
+        }
+
+        if (response.body().empty()) {
+            throw LogicError("Response body is empty (are you trying to download non-animated avatar as GIF?)", -1);
+        }
+        if (response.statusCode != 200) {
+            throw LogicError(std::string("HTTP status code: ") + std::to_string(response.statusCode), -1);
+        }
+
+        return std::move(response.body());
+    }
+
+    File CdnClient::downloadFile(const std::string& path) {
+        if (cache) {
+            boost::optional<File> cached = cache->lookup(path);
+            if (cached) return *cached;
+
+            return cache->store(path, download(path));
+        }
+
+        std::string filename = Utils::split(Utils::split(path, '?').front(), '/').back();
+        return File(filename, download(path));
+    }
+
+    std::future<std::vector<uint8_t>> CdnClient::asyncDownload(const std::string& path) {
+        auto promise = std::make_shared<std::promise<std::vector<uint8_t>>>();
+        std::future<std::vector<uint8_t>> result = promise->get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(workersMutex);
+            if (!workers) workers.reset(new WorkerPool(connectionsCount));
+        }
+
+        workers->post([this, path, promise]() {
+            try {
+                promise->set_value(download(path));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return result;
+    }
+
+    std::vector<std::future<std::vector<uint8_t>>> CdnClient::downloadBatch(const std::vector<std::string>& paths) {
+        std::vector<std::future<std::vector<uint8_t>>> result;
+        result.reserve(paths.size());
+
+        for (const std::string& path : paths) {
+            result.push_back(asyncDownload(path));
+        }
+        return result;
+    }
+
+    std::future<void> CdnClient::prewarm() {
+        return std::async(std::launch::async, [this]() {
+            std::vector<std::future<void>> tasks;
+            for (size_t i = 0; i < connections.size(); ++i) {
+                tasks.push_back(std::async(std::launch::async, [this]() {
+                    RequestScheduler::Turn turn(*scheduler, 0);
+                    if (!connections[turn.slot]->isOpen()) connections[turn.slot]->open();
+                }));
+            }
+            for (std::future<void>& task : tasks) task.get();
+        });
+    }
+
+    CdnClient& CdnClient::forService(boost::asio::io_service& ioService) {
+        return boost::asio::use_service<CdnService>(ioService).client;
+    }
+} // namespace Hexicord
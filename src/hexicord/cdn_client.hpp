@@ -0,0 +1,135 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_CDN_CLIENT_HPP
+#define HEXICORD_CDN_CLIENT_HPP
+
+#include <cstdint>              // uint8_t
+#include <future>               // std::future
+#include <memory>               // std::shared_ptr
+#include <mutex>                // std::mutex
+#include <string>               // std::string
+#include <vector>               // std::vector
+#include "hexicord/image_cache.hpp"     // Hexicord::ImageCache
+#include "hexicord/types/file.hpp"      // Hexicord::File
+namespace boost { namespace asio { class io_service; }}
+namespace Hexicord { namespace REST { class HTTPSConnection; }}
+namespace Hexicord { class RequestScheduler; class WorkerPool; }
+
+namespace Hexicord {
+    /**
+     * Downloads files from cdn.discordapp.com using pool of keep-alive
+     * connections, so TLS handshake is done once per connection, not
+     * once per file.
+     *
+     * You usually don't need to create CdnClient yourself,
+     * \ref ImageReference::download uses instance shared by all users of
+     * same io_service (see \ref forService).
+     *
+     * All methods are thread-safe.
+     */
+    class CdnClient {
+    public:
+        /**
+         * \param ioService        ASIO I/O service. Should not be destroyed while
+         *                         CdnClient exists.
+         * \param connectionsCount Max count of downloads performed at once.
+         */
+        CdnClient(boost::asio::io_service& ioService, unsigned connectionsCount = 4);
+
+        /**
+         * Waits for pending asynchronous downloads.
+         */
+        ~CdnClient();
+
+        CdnClient(const CdnClient&) = delete;
+        CdnClient& operator=(const CdnClient&) = delete;
+
+        /**
+         * Download file, blocks if all connections are busy.
+         *
+         * \param path Path on CDN, like "/avatars/{user_id}/{hash}.png".
+         *
+         * \throws LogicError if response is not 200 OK or body is empty.
+         * \throws boost::system::system_error on connection error.
+         */
+        std::vector<uint8_t> download(const std::string& path);
+
+        /**
+         * Same as \ref download, but uses \ref cache if set. Last component
+         * of path is used as filename.
+         */
+        File downloadFile(const std::string& path);
+
+        /**
+         * Download file in background, exceptions are rethrown from
+         * future's get().
+         */
+        std::future<std::vector<uint8_t>> asyncDownload(const std::string& path);
+
+        /**
+         * Download multiple files concurrently. Futures are in same order
+         * as paths.
+         */
+        std::vector<std::future<std::vector<uint8_t>>> downloadBatch(const std::vector<std::string>& paths);
+
+        /**
+         * Open all connections in background, see \ref RestClient::prewarm.
+         */
+        std::future<void> prewarm();
+
+        /**
+         * Get CdnClient shared by all users of ioService, it's created
+         * on first use and destroyed together with ioService.
+         */
+        static CdnClient& forService(boost::asio::io_service& ioService);
+
+        /**
+         * Disk cache used by \ref downloadFile, disabled by default.
+         *
+         * ```cpp
+         * Hexicord::CdnClient::forService(ioService).cache =
+         *     std::make_shared<Hexicord::ImageCache>("/var/cache/bot/images");
+         * ```
+         *
+         * Set it before downloads are started.
+         */
+        std::shared_ptr<ImageCache> cache;
+
+        const std::string serverName = "cdn.discordapp.com";
+        const unsigned connectionsCount;
+    private:
+        boost::asio::io_service& ioService;
+
+        // We have to use std::shared_ptr instead of std::unique_ptr because
+        // latter requires complete type but we forward-declare these types.
+        std::vector<std::shared_ptr<REST::HTTPSConnection>> connections;
+        std::shared_ptr<RequestScheduler> scheduler;
+
+        // Created on first asynchronous download. Declared last, so it's
+        // destroyed (and pending tasks finished) before connections.
+        std::mutex workersMutex;
+        std::shared_ptr<WorkerPool> workers;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_CDN_CLIENT_HPP
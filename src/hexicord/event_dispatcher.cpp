@@ -21,11 +21,17 @@
 
 #include "hexicord/event_dispatcher.hpp"
 
+#include "hexicord/internal/json_backend.hpp" // Hexicord::JsonBackend::parse
+
 namespace Hexicord {
     void EventDispatcher::addHandler(Event eventType, const EventDispatcher::EventHandler& handler) {
         handlers[eventType].push_back(handler);
     }
 
+    void EventDispatcher::addRawHandler(Event eventType, const EventDispatcher::RawEventHandler& handler) {
+        rawHandlers[eventType].push_back(handler);
+    }
+
     void EventDispatcher::dispatchEvent(Event type, const nlohmann::json& payload) const {
         if (type == Event::Unknown) {
             for (const auto& handler : unknownEventHandlers) {
@@ -39,5 +45,37 @@ namespace Hexicord {
         for (const auto& handler : handlers.at(type)) {
             handler(payload);
         }
+
+        auto raw = rawHandlers.find(type);
+        if (raw != rawHandlers.end() && !raw->second.empty()) {
+            const std::string text = payload.dump();
+            for (const auto& handler : raw->second) {
+                handler(text);
+            }
+        }
+    }
+
+    void EventDispatcher::dispatchRawEvent(Event type, boost::string_view payload) const {
+        if (type == Event::Unknown) {
+            if (!unknownEventHandlers.empty()) {
+                dispatchEvent(type, JsonBackend::parse(payload));
+            }
+            return;
+        }
+
+        auto raw = rawHandlers.find(type);
+        if (raw != rawHandlers.end()) {
+            for (const auto& handler : raw->second) {
+                handler(payload);
+            }
+        }
+
+        const auto& domHandlers = handlers.at(type);
+        if (domHandlers.empty()) return;
+
+        const nlohmann::json parsed = JsonBackend::parse(payload);
+        for (const auto& handler : domHandlers) {
+            handler(parsed);
+        }
     }
 } // namespace Hexicord
@@ -22,12 +22,13 @@
 #ifndef HEXICORD_EVENTDISPATCHER_HPP
 #define HEXICORD_EVENTDISPATCHER_HPP 
 
-#include <unordered_map>        // std::unordered_map
-#include <functional>           // std::function
-#include <cstddef>              // size_t
-#include <string>               // std::string
-#include <vector>               // std::vector
-#include "hexicord/json.hpp"    // nlohmann::json
+#include <unordered_map>                 // std::unordered_map
+#include <functional>                    // std::function
+#include <cstddef>                       // size_t
+#include <string>                        // std::string
+#include <vector>                        // std::vector
+#include <boost/utility/string_view.hpp> // boost::string_view
+#include "hexicord/json.hpp"             // nlohmann::json
 
 namespace Hexicord {
     enum class Event {
@@ -76,10 +77,42 @@ namespace Hexicord {
     public:
         using EventHandler        = std::function<void(const nlohmann::json&)>;
         using UnknownEventHandler = std::function<void(const std::string&, const nlohmann::json&)>;
+        using RawEventHandler     = std::function<void(boost::string_view)>;
 
         void addHandler(Event eventType, const EventHandler& handler);
 
+        /**
+         * Add handler that receives event payload as JSON text. Payload
+         * of events that have only raw handlers is never parsed into
+         * nlohmann::json.
+         *
+         * \note View is valid only during handler call.
+         */
+        void addRawHandler(Event eventType, const RawEventHandler& handler);
+
+        /**
+         * Add handler that receives payload decoded into model from
+         * models.hpp, e.g.:
+         * ```cpp
+         * dispatcher.addTypedHandler<Message>(Event::MessageCreate, [](const Message& message) {
+         *     ...
+         * });
+         * ```
+         */
+        template<typename Model>
+        void addTypedHandler(Event eventType, const std::function<void(const Model&)>& handler) {
+            addRawHandler(eventType, [handler](boost::string_view payload) {
+                handler(Model::fromJson(payload));
+            });
+        }
+
         void dispatchEvent(Event type, const nlohmann::json& payload) const;
+
+        /**
+         * Same as dispatchEvent but takes payload as JSON text, it's parsed
+         * into nlohmann::json only if there are handlers added using addHandler.
+         */
+        void dispatchRawEvent(Event type, boost::string_view payload) const;
     private:
         static const std::unordered_map<std::string, Event> stringToEnum;
 
@@ -119,6 +152,8 @@ namespace Hexicord {
             { Event::WebhooksUpdate, {} }
         };
 
+        std::unordered_map<Event, std::vector<RawEventHandler>, EventHash> rawHandlers;
+
         std::vector<UnknownEventHandler> unknownEventHandlers;
 
     };
@@ -49,6 +49,14 @@ namespace Hexicord {
             : RESTError(std::string("Ratelimit hit for route ") + route, -1, 429) {}
     };
 
+    /// Thrown without performing request if route failed too many times
+    /// recently. \sa \ref CircuitBreaker
+    class CircuitOpen : public RESTError {
+    public:
+        CircuitOpen(const std::string& route)
+            : RESTError(std::string("Too many recent failures for route ") + route) {}
+    };
+
     /// Thrown when client tries to access non-existent entity (probably invalid snowflake).
     /// See entityType for details.
     class UnknownEntity : public RESTError {
@@ -23,12 +23,18 @@
 
 #include <cassert>                         // assert
 #include <chrono>                          // std::chrono::steady_clock
+#include <condition_variable>              // std::condition_variable
+#include <list>                            // std::list
+#include <memory>                          // std::shared_ptr, std::atomic_load, std::atomic_store
+#include <mutex>                           // std::mutex, std::lock_guard, std::unique_lock
 #include <unordered_map>                   // std::unordered_map
 #include <boost/asio/error.hpp>            // boost::asio::error
 #include <boost/asio/io_service.hpp>       // boost::asio::io_service
 #include <boost/beast/websocket/error.hpp> // boost::beast::websocket::error
 #include "hexicord/config.hpp"             // HEXICORD_ZLIB HEXICORD_DEBUG_LOG
 #include "hexicord/internal/wss.hpp"       // Hexicord::TLSWebSocket
+#include "hexicord/internal/json_backend.hpp" // Hexicord::JsonBackend
+#include "hexicord/internal/json_writer.hpp" // Hexicord::JsonWriter
 #include "hexicord/internal/utils.hpp"     // Hexicord::Utils::domainFromUrl
 
 #ifdef HEXICORD_ZLIB
@@ -59,8 +65,98 @@
 
 namespace Hexicord {
 
+namespace {
+    // Envelope is written by hand so payload is not copied into wrapping object.
+    void writeEnvelope(JsonWriter& writer, int opCode, const nlohmann::json& payload, const std::string& t) {
+        writer.clear();
+        writer.appendRaw("{\"op\":");
+        writer.appendNumber(opCode);
+        writer.appendRaw(",\"d\":");
+        writer.append(payload);
+        if (!t.empty()) {
+            writer.appendRaw(",\"t\":");
+            writer.append(t);
+        }
+        writer.appendRaw("}");
+    }
+} // namespace
+
+struct GatewayClient::OutboundBuffer {
+    struct Message {
+        std::vector<char> data;
+        std::shared_ptr<TLSWebSocket> connection;
+        bool started = false;       // async write is in progress
+        bool shutdownAfter = false; // shutdown connection once written (CLOSE)
+    };
+
+    std::mutex mutex;
+    std::condition_variable written; // notified when async write completes
+    JsonWriter writer;
+
+    // Messages to be written by writeNext, each tagged with connection it
+    // was sent to. Nodes with their buffers move between queue and spare,
+    // so steady-state sending allocates nothing. Front of queue must not be
+    // removed while started, write handler refers to its data.
+    std::list<Message> queue;
+    std::list<Message> spare;
+    bool writing = false;
+
+    // All members below must be called with mutex locked.
+
+    // Serialize message into recycled buffer and append it to queue.
+    Message& push(const std::shared_ptr<TLSWebSocket>& connection,
+                  int opCode, const nlohmann::json& payload, const std::string& t) {
+        if (spare.empty()) spare.emplace_back();
+
+        writeEnvelope(writer, opCode, payload, t);
+        Message& message = spare.front();
+        writer.swapBuffer(message.data);
+        message.connection    = connection;
+        message.started       = false;
+        message.shutdownAfter = false;
+
+        queue.splice(queue.end(), spare, spare.begin());
+        return message;
+    }
+
+    void recycle(std::list<Message>::iterator message) {
+        message->connection.reset();
+        spare.splice(spare.begin(), queue, message);
+    }
+
+    // Drop messages not yet started, for given connection or all.
+    void dropPending(const std::shared_ptr<TLSWebSocket>& connection = nullptr) {
+        for (auto it = queue.begin(); it != queue.end();) {
+            auto current = it++;
+            if (current->started) continue;
+            if (connection && current->connection != connection) continue;
+            recycle(current);
+        }
+    }
+
+    bool busy(const std::shared_ptr<TLSWebSocket>& connection) const {
+        return !queue.empty() && queue.front().started && queue.front().connection == connection;
+    }
+
+    // Write message synchronously once async write to same connection (if
+    // any) completes. Completion runs in strand, so without canWait
+    // (called from strand or event loop stopped) returns false instead.
+    bool writeNow(std::unique_lock<std::mutex>& lock, bool canWait,
+                  const std::shared_ptr<TLSWebSocket>& connection,
+                  int opCode, const nlohmann::json& payload, const std::string& t) {
+        if (busy(connection)) {
+            if (!canWait) return false;
+            written.wait(lock, [this, &connection]() { return !busy(connection); });
+        }
+
+        writeEnvelope(writer, opCode, payload, t);
+        connection->sendMessage(reinterpret_cast<const uint8_t*>(writer.data()), writer.size());
+        return true;
+    }
+};
+
 GatewayClient::GatewayClient(boost::asio::io_service& ioService, const std::string& token)
-    : ioService(ioService), token_(token), heartbeatTimer(ioService) {}
+    : ioService(ioService), token_(token), outbound(new OutboundBuffer), heartbeatTimer(ioService), strand(ioService) {}
 
 GatewayClient::~GatewayClient() {
     if (gatewayConnection && activeSession && gatewayConnection->isSocketOpen()) disconnect(2000);
@@ -73,13 +169,11 @@ nlohmann::json GatewayClient::parseGatewayMessage(const std::vector<uint8_t>& ms
     }
 
 #ifdef HEXICORD_ZLIB
-    if (msg.at(0) == '{') {
-        return nlohmann::json::parse(msg);
+    if (msg.at(0) != '{') {
+        return parseGatewayMessage(Zlib::decompress(msg));
     }
-    return nlohmann::json::parse(Zlib::decompress(msg));
-#else
-    return nlohmann::json::parse(msg);
 #endif
+    return JsonBackend::parse(boost::string_view(reinterpret_cast<const char*>(msg.data()), msg.size()));
 }
 
 void GatewayClient::connect(const std::string& gatewayUrl, int shardId, int shardCount,
@@ -89,12 +183,15 @@ void GatewayClient::connect(const std::string& gatewayUrl, int shardId, int shar
     activeSession = false;
 
     DEBUG_MSG("Connecting...");
-    if (!gatewayConnection)                 gatewayConnection.reset(new TLSWebSocket(ioService));
-    if (!gatewayConnection->isSocketOpen()) gatewayConnection->handshake(Utils::domainFromUrl(gatewayUrl),
-                                                                         gatewayPathSuffix, 443);
+    std::shared_ptr<TLSWebSocket> connection = std::atomic_load(&gatewayConnection);
+    if (!connection) {
+        connection = std::make_shared<TLSWebSocket>(strand);
+        std::atomic_store(&gatewayConnection, connection);
+    }
+    if (!connection->isSocketOpen()) connection->handshake(Utils::domainFromUrl(gatewayUrl), gatewayPathSuffix, 443);
 
     DEBUG_MSG("Reading Hello message...");
-    const nlohmann::json gatewayHello = parseGatewayMessage(gatewayConnection->readMessage());
+    const nlohmann::json gatewayHello = parseGatewayMessage(connection->readMessage());
 
     heartbeatIntervalMs = gatewayHello.at("d").at("heartbeat_interval");
     DEBUG_MSG(std::string("Gateway heartbeat interval: ") + std::to_string(heartbeatIntervalMs) + " ms.");
@@ -123,7 +220,7 @@ void GatewayClient::connect(const std::string& gatewayUrl, int shardId, int shar
     }
 
     DEBUG_MSG("Sending Identify message...");
-    sendMessage(OpCode::Identify, message);
+    if (!sendMessageNow(OpCode::Identify, message)) DEBUG_MSG("Identify message queued.");
 
     activeSession = true;
 
@@ -143,9 +240,8 @@ void GatewayClient::connect(const std::string& gatewayUrl, int shardId, int shar
     lastSequenceNumber_ = 0;
     lastPresence        = initialPresence;
 
-    // Already started by waitForEvent.
-    // poll = true;
-    // asyncPoll();
+    poll = true;
+    asyncPoll();
 }
 
 void GatewayClient::resume(const std::string& gatewayUrl,
@@ -157,15 +253,19 @@ void GatewayClient::resume(const std::string& gatewayUrl,
 
     if (activeSession) disconnect(2000);
    
-    if (!gatewayConnection) gatewayConnection.reset(new TLSWebSocket(ioService));
-    if (!gatewayConnection->isSocketOpen()) gatewayConnection->handshake(Utils::domainFromUrl(gatewayUrl), gatewayPathSuffix, 443);
+    std::shared_ptr<TLSWebSocket> connection = std::atomic_load(&gatewayConnection);
+    if (!connection) {
+        connection = std::make_shared<TLSWebSocket>(strand);
+        std::atomic_store(&gatewayConnection, connection);
+    }
+    if (!connection->isSocketOpen()) connection->handshake(Utils::domainFromUrl(gatewayUrl), gatewayPathSuffix, 443);
 
     // FIXME: erroneous double handshake? seems to fail with "unexpected record"
 //    DEBUG_MSG("Performing WebSocket handshake...");
 //    gatewayConnection->handshake(Utils::domainFromUrl(gatewayUrl), gatewayPathSuffix, 443);
 
     DEBUG_MSG("Reading Hello message.");
-    const nlohmann::json gatewayHello = parseGatewayMessage(gatewayConnection->readMessage());
+    const nlohmann::json gatewayHello = parseGatewayMessage(connection->readMessage());
 
     heartbeatIntervalMs = gatewayHello.at("d").at("heartbeat_interval");
     DEBUG_MSG(std::string("Gateway heartbeat interval: ") + std::to_string(heartbeatIntervalMs) + " ms.");
@@ -174,11 +274,11 @@ void GatewayClient::resume(const std::string& gatewayUrl,
     asyncHeartbeat();
 
     DEBUG_MSG("Sending Resume message...");
-    sendMessage(OpCode::Resume, {
+    if (!sendMessageNow(OpCode::Resume, {
         { "token",      token_             },
         { "session_id", sessionId          },
         { "seq",        lastSequenceNumber }
-    });
+    })) DEBUG_MSG("Resume message queued.");
 
     DEBUG_MSG("Waiting for Resumed event...");
 
@@ -193,34 +293,83 @@ void GatewayClient::resume(const std::string& gatewayUrl,
     lastGatewayUrl_     = gatewayUrl;
     sessionId_          = sessionId;
     lastSequenceNumber_ = lastSequenceNumber;
+
+    poll = true;
+    asyncPoll();
 }
 
 void GatewayClient::disconnect(int code) noexcept {
     DEBUG_MSG(std::string("Disconnecting from gateway... code=") + std::to_string(code));
-    try {
-        if (code != NoCloseEvent && !activeSendMessage) sendMessage(OpCode::EventDispatch, nlohmann::json(code), "CLOSE");
-    } catch (...) { // whatever happened - we don't care.
-    }
 
     heartbeat = false;
     heartbeatTimer.cancel();
 
     poll = false;
 
-    gatewayConnection.reset(nullptr);
+    const bool canWait = !strand.running_in_this_thread() && !ioService.stopped();
+
+    std::shared_ptr<TLSWebSocket> connection;
+    bool shutdownQueued = false;
+    {
+        std::unique_lock<std::mutex> lock(outbound->mutex);
+        connection = std::atomic_exchange(&gatewayConnection, std::shared_ptr<TLSWebSocket>());
+
+        // Pending messages are meaningless for new session.
+        outbound->dropPending();
+
+        try {
+            if (connection && code != NoCloseEvent &&
+                !outbound->writeNow(lock, canWait, connection, OpCode::EventDispatch, nlohmann::json(code), "CLOSE")) {
+
+                if (!ioService.stopped()) {
+                    // Write in progress, so chain is running and picks it up.
+                    outbound->push(connection, OpCode::EventDispatch, nlohmann::json(code), "CLOSE").shutdownAfter = true;
+                    shutdownQueued = true;
+                } else {
+                    DEBUG_MSG("Event loop is stopped while write is in progress, close event is not sent.");
+                }
+            }
+        } catch (...) { // whatever happened - we don't care.
+        }
+    }
+
+    // Pending read holds socket, close it to abort read. Socket is not
+    // thread-safe, so this is done in strand unless nothing else can run.
+    if (connection && !shutdownQueued) {
+        if (ioService.stopped()) {
+            connection->shutdown();
+        } else {
+            strand.dispatch([connection]() { connection->shutdown(); });
+        }
+    }
 
     activeSession = false;
 }
 
 nlohmann::json GatewayClient::waitForEvent(Event type) {
     DEBUG_MSG(std::string("Waiting for event, type=") + std::to_string(unsigned(type)));
-    skipMessages = true;
 
     if (!poll) {
-        poll = true;
-        asyncPoll();
+        // No read in progress, so read directly. This doesn't need event
+        // loop, so works from strand too (connect and resume are called
+        // there on reconnect).
+        std::shared_ptr<TLSWebSocket> connection = std::atomic_load(&gatewayConnection);
+        while (true) {
+            const nlohmann::json message = parseGatewayMessage(connection->readMessage());
+            if (message.is_null() || message.empty()) continue;
+
+            if (message.at("op") == OpCode::EventDispatch &&
+                eventEnumFromString(message.at("t")) == type) {
+
+                return message.at("d");
+            }
+
+            processMessage(message);
+        }
     }
 
+    skipMessages = true;
+
     while (true) {
         lastMessage = {};
 
@@ -266,45 +415,51 @@ void GatewayClient::asyncPoll() {
     assert(activeSession);
 
     DEBUG_MSG("Polling gateway messages...");
-    gatewayConnection->asyncReadMessage([this](TLSWebSocket&, const std::vector<uint8_t>& body,
-                                               boost::system::error_code ec) {
-        if (!poll) return;
-
-        if (ec != boost::system::errc::success) {
-            DEBUG_MSG("asyncReadMessage body length: " + std::to_string(body.size()));
-            DEBUG_MSG("asyncReadMessage error: " + ec.message());
-
-            // Just reconnect always for now
-            // seems like SSL socket can be closed with a short_read error too
-            recoverConnection();
+    // Read is started in strand, so it doesn't race with writes.
+    std::shared_ptr<TLSWebSocket> connection = std::atomic_load(&gatewayConnection);
+    strand.dispatch([this, connection]() {
+        connection->asyncReadMessage([this, connection](TLSWebSocket&, const std::vector<uint8_t>& body,
+                                                        boost::system::error_code ec) {
+            // Read from connection closed by disconnect.
+            if (!poll || connection != std::atomic_load(&gatewayConnection)) return;
+
+            if (ec != boost::system::errc::success) {
+                DEBUG_MSG("asyncReadMessage body length: " + std::to_string(body.size()));
+                DEBUG_MSG("asyncReadMessage error: " + ec.message());
+
+                // Just reconnect always for now
+                // seems like SSL socket can be closed with a short_read error too
+                // New connection is polled by resume or connect.
+                recoverConnection();
 /*
-            if (ec == boost::asio::error::broken_pipe ||
-                ec == boost::asio::error::connection_reset ||
-                ec == boost::beast::websocket::error::closed) recoverConnection();
+                if (ec == boost::asio::error::broken_pipe ||
+                    ec == boost::asio::error::connection_reset ||
+                    ec == boost::beast::websocket::error::closed) recoverConnection();
 */
-            if (poll) asyncPoll();
-            return;
-        }
-
-        try {
-            const nlohmann::json message = parseGatewayMessage(body);
-
-            lastMessage = message;
-            if (!skipMessages
-                    && !message.is_null()
-                    && !message.empty())
-                processMessage(message);
-        } catch (nlohmann::json::parse_error& excp) {
-            DEBUG_MSG("Corrupted message, assuming connection error, reconnecting...");
-            DEBUG_MSG(excp.what());
-            DEBUG_MSG(std::string(body.begin(), body.end()));
-
-            // we may fail here because of partially readen message (what
-            // means gateway dropped our connection).
-            recoverConnection();
-        }
-
-        if (poll) asyncPoll();
+                return;
+            }
+
+            try {
+                if (skipMessages) {
+                    // waitForEvent inspects whole message.
+                    lastMessage = parseGatewayMessage(body);
+                } else {
+                    processRawMessage(body);
+                }
+            } catch (nlohmann::json::parse_error& excp) {
+                DEBUG_MSG("Corrupted message, assuming connection error, reconnecting...");
+                DEBUG_MSG(excp.what());
+                DEBUG_MSG(std::string(body.begin(), body.end()));
+
+                // we may fail here because of partially readen message (what
+                // means gateway dropped our connection).
+                recoverConnection();
+                return;
+            }
+
+            // Handlers may have disconnected or reconnected (which starts new poll).
+            if (poll && connection == std::atomic_load(&gatewayConnection)) asyncPoll();
+        });
     });
 }
 
@@ -351,6 +506,33 @@ Event GatewayClient::eventEnumFromString(const std::string& str) {
     return it->second;
 }
 
+void GatewayClient::processRawMessage(const std::vector<uint8_t>& msg) {
+    if (msg.size() == 0) {
+        DEBUG_MSG("Got an empty gateway message!");
+        return;
+    }
+
+#ifdef HEXICORD_ZLIB
+    if (msg.at(0) != '{') {
+        processRawMessage(Zlib::decompress(msg));
+        return;
+    }
+#endif
+
+    const boost::string_view text(reinterpret_cast<const char*>(msg.data()), msg.size());
+    const JsonBackend::GatewayEnvelope envelope = JsonBackend::scanGatewayEnvelope(text);
+
+    if (envelope.op != OpCode::EventDispatch) {
+        processMessage(JsonBackend::parse(text));
+        return;
+    }
+
+    eventNameBuffer.assign(envelope.t.data(), envelope.t.size());
+    DEBUG_MSG(std::string("Gateway Event: t=") + eventNameBuffer + " s=" + std::to_string(envelope.s));
+    lastSequenceNumber_ = envelope.s;
+    eventDispatcher.dispatchRawEvent(eventEnumFromString(eventNameBuffer), envelope.d);
+}
+
 void GatewayClient::processMessage(const nlohmann::json& message) {
     switch (message.at("op").get<int>()) {
     case OpCode::EventDispatch:
@@ -372,7 +554,7 @@ void GatewayClient::processMessage(const nlohmann::json& message) {
     case OpCode::Heartbeat:
         assert(activeSession);
         DEBUG_MSG("Received heartbeat request.");
-        sendMessage(OpCode::Heartbeat, nlohmann::json(lastSequenceNumber_));
+        sendMessage(OpCode::Heartbeat, nlohmann::json(lastSequenceNumber_.load()));
         ++unansweredHeartbeats;
         break;
     case OpCode::Reconnect:
@@ -394,33 +576,90 @@ void GatewayClient::processMessage(const nlohmann::json& message) {
 }
 
 void GatewayClient::sendMessage(GatewayClient::OpCode opCode, const nlohmann::json& payload, const std::string& t) {
-    nlohmann::json message = {
-        { "op", opCode  },
-        { "d",  payload },
-    };
+    {
+        std::lock_guard<std::mutex> lock(outbound->mutex);
+
+        // Loaded under lock, so disconnect can't drop queue between load and push.
+        std::shared_ptr<TLSWebSocket> connection = std::atomic_load(&gatewayConnection);
+        if (!connection) throw GatewayError("Not connected to gateway.");
 
-    if (!t.empty()) {
-        message["t"] = t;
+        outbound->push(connection, opCode, payload, t);
+
+        // Otherwise message will be picked up by running write.
+        if (outbound->writing) return;
+        outbound->writing = true;
     }
 
-    std::string messageString = message.dump();
+    strand.dispatch([this]() { writeNext(); });
+}
 
-    activeSendMessage = true;
-    gatewayConnection->sendMessage(std::vector<uint8_t>(messageString.begin(), messageString.end()));
-    activeSendMessage = false;
+bool GatewayClient::sendMessageNow(GatewayClient::OpCode opCode, const nlohmann::json& payload, const std::string& t) {
+    {
+        std::unique_lock<std::mutex> lock(outbound->mutex);
+
+        std::shared_ptr<TLSWebSocket> connection = std::atomic_load(&gatewayConnection);
+        if (!connection) throw GatewayError("Not connected to gateway.");
+
+        const bool canWait = !strand.running_in_this_thread() && !ioService.stopped();
+        if (outbound->writeNow(lock, canWait, connection, opCode, payload, t)) return true;
+    }
+
+    sendMessage(opCode, payload, t);
+    return false;
+}
+
+void GatewayClient::writeNext() {
+    OutboundBuffer::Message* message;
+    {
+        std::lock_guard<std::mutex> lock(outbound->mutex);
+        if (outbound->queue.empty()) {
+            outbound->writing = false;
+            return;
+        }
+        message = &outbound->queue.front();
+        message->started = true;
+    }
+
+    // List node is stable and not removed while started, so data is
+    // written directly from it.
+    const std::shared_ptr<TLSWebSocket> connection = message->connection;
+    connection->asyncSendMessage(reinterpret_cast<const uint8_t*>(message->data.data()), message->data.size(),
+                                 [this, connection](TLSWebSocket&, boost::system::error_code ec) {
+        bool shutdownAfter, more;
+        {
+            std::lock_guard<std::mutex> lock(outbound->mutex);
+
+            shutdownAfter = outbound->queue.front().shutdownAfter;
+            outbound->recycle(outbound->queue.begin());
+            if (ec) {
+                // Read fails too and recovers connection, queued messages
+                // are meaningless for new session.
+                DEBUG_MSG("asyncSendMessage error: " + ec.message());
+                outbound->dropPending(connection);
+            }
+
+            more = !outbound->queue.empty();
+            if (!more) outbound->writing = false;
+        }
+        outbound->written.notify_all();
+
+        // Deferred by disconnect until close event is written.
+        if (shutdownAfter) connection->shutdown();
+        if (more) writeNext();
+    });
 }
 
 void GatewayClient::asyncHeartbeat() {
     heartbeatTimer.cancel();
     heartbeatTimer.expires_from_now(std::chrono::milliseconds(heartbeatIntervalMs));
-    heartbeatTimer.async_wait([this](const boost::system::error_code& ec){
+    heartbeatTimer.async_wait(strand.wrap([this](const boost::system::error_code& ec){
         if (ec == boost::asio::error::operation_aborted) return;
         if (!heartbeat) return;
 
         sendHeartbeat();
 
         asyncHeartbeat();
-    });
+    }));
 }
 
 void GatewayClient::sendHeartbeat() {
@@ -432,7 +671,7 @@ void GatewayClient::sendHeartbeat() {
     }
 
     DEBUG_MSG("Gateway heartbeat sent.");
-    sendMessage(OpCode::Heartbeat, nlohmann::json(lastSequenceNumber_));
+    sendMessage(OpCode::Heartbeat, nlohmann::json(lastSequenceNumber_.load()));
     ++unansweredHeartbeats;
 }
 
@@ -22,16 +22,18 @@
 #ifndef HEXICORD_GATEWAY_CLIENT_HPP
 #define HEXICORD_GATEWAY_CLIENT_HPP
 
+#include <atomic>                        // std::atomic
 #include <cstdint>                       // uint8_t
-#include <memory>                        // std::unique_ptr
+#include <memory>                        // std::unique_ptr, std::shared_ptr
 #include <stdexcept>                     // std::runtime_error
 #include <string>                        // std::string
 #include <vector>                        // std::vector
+#include <boost/asio/io_service.hpp>     // boost::asio::io_service
 #include <boost/asio/steady_timer.hpp>   // boost::asio::steady_timer
+#include <boost/asio/strand.hpp>         // boost::asio::io_service::strand
 #include <hexicord/event_dispatcher.hpp> // Hexicord::Event, Hexicord::EventDispatcher
 #include <hexicord/json.hpp>             // nlohmann::json
 namespace Hexicord { class TLSWebSocket; }
-namespace boost { namespace asio { class io_service; } }
 
 namespace Hexicord {
     /**
@@ -50,6 +52,22 @@ namespace Hexicord {
     };
 
 
+    /**
+     * Gateway connection.
+     *
+     * Heartbeats, message reads and event handlers run through one strand,
+     * so io_service::run() can be called from several threads: handlers of
+     * one GatewayClient never run concurrently, while other clients (shards)
+     * and other asynchronous work use remaining threads.
+     *
+     * \ref updatePresence can be called from any thread, including event
+     * handlers. \ref connect and \ref resume block until session is ready and
+     * should be called before io_service::run() is started in other threads
+     * (or from event handlers). \ref waitForEvent and \ref disconnect should
+     * not be called while other threads run io_service, except from event
+     * handlers for disconnect. Handlers should be added to \ref eventDispatcher
+     * before io_service is run.
+     */
     class GatewayClient {
     public:
         static constexpr int NoSharding = -1;
@@ -59,10 +77,10 @@ namespace Hexicord {
         ~GatewayClient();
 
         GatewayClient(const GatewayClient&) = delete;
-        GatewayClient(GatewayClient&&) = default;
+        GatewayClient(GatewayClient&&) = delete;
 
         GatewayClient& operator=(const GatewayClient&) = delete;
-        GatewayClient& operator=(GatewayClient&&) = default;
+        GatewayClient& operator=(GatewayClient&&) = delete;
 
         /**
          * Connect and identify to gateway.
@@ -93,9 +111,9 @@ namespace Hexicord {
          * \internal
          * **Implementation**
          *
-         * If connection is not open - open it, send identify payload, wait for first
-         * gateway message, if it's ready event - start gateway polling, if it's
-         * invalid session error - throw exception.
+         * If connection is not open - open it, send identify payload, read
+         * messages synchronously until ready event, then start gateway polling.
+         * If invalid session error received - throw exception.
          */
         void connect(const std::string& gatewayUrl,
                      /* sharding info: */ int shardId = NoSharding, int shardCount = NoSharding,
@@ -127,8 +145,9 @@ namespace Hexicord {
          * \internal
          * **Implementation**
          *
-         * If connection is not open - open it, send resume event, block until
-         * either Resumed event or Invalid Session received.
+         * If connection is not open - open it, send resume event, read
+         * messages synchronously until either Resumed event or Invalid Session
+         * received.
          * If Resumed event - start gateway polling and heartbeating.
          * If Invalid session - throw exception.
          */
@@ -163,11 +182,17 @@ namespace Hexicord {
          *
          * It's better to use async handlers, since behavior of this method is
          * not well defined in all cases.
+         *
+         * If polling is already started, this method runs io_service itself,
+         * so it can't be used while io_service is run by other threads or
+         * from event handlers.
          */
         nlohmann::json waitForEvent(Event type);
 
         /**
          * Update presence (user status).
+         *
+         * Message is queued and written asynchronously. Thread-safe.
          */
         void updatePresence(const nlohmann::json& newPresence);
 
@@ -195,6 +220,7 @@ namespace Hexicord {
             return sessionId_;
         }
 
+        /// Thread-safe.
         inline int lastSequenceNumber() const {
             return lastSequenceNumber_;
         }
@@ -224,44 +250,73 @@ private:
 
         // Poll gateway connection using async read while poll = true, calls
         // processMessage for each message if skipMessages is not set.
-        // Saves last received message in lastMessage.
+        // Saves last received message in lastMessage. Read is started
+        // through strand, so can be called from any thread.
         void asyncPoll();
-        bool poll = false, skipMessages = false;
+        std::atomic<bool> poll { false }, skipMessages { false };
         nlohmann::json lastMessage;
 
         Event eventEnumFromString(const std::string& str);
 
         nlohmann::json parseGatewayMessage(const std::vector<uint8_t>& msg);
         void processMessage(const nlohmann::json& message);
+
+        // Scans only envelope (op, t, s) of message and passes "d" to
+        // EventDispatcher as text, falls back to processMessage for
+        // everything except event dispatch.
+        void processRawMessage(const std::vector<uint8_t>& msg);
+
+        // Reused to look up event type without allocation.
+        std::string eventNameBuffer;
+
+        // Queue message for asynchronous write, thread-safe.
         void sendMessage(OpCode opCode, const nlohmann::json& payload = {}, const std::string& t = "");
 
-        // Set if sendMessage entered.
-        bool activeSendMessage = false;
+        // Write message synchronously, used only while there is no polling
+        // (connect, resume). Waits for asynchronous write in progress, if
+        // that's impossible (called from strand or event loop stopped)
+        // queues message instead and returns false.
+        bool sendMessageNow(OpCode opCode, const nlohmann::json& payload = {}, const std::string& t = "");
+
+        // Starts writing first queued message to its connection, runs in strand.
+        void writeNext();
+
+        // Reusable serialization buffer and write queue, guarded by mutex
+        // because sendMessage is called both from event loop (heartbeats)
+        // and from user threads.
+        struct OutboundBuffer;
+        std::unique_ptr<OutboundBuffer> outbound;
 
         // Calls sendHeartbeat every heartbeatIntervalMs milliseconds using
         // heartbeatTimer while heartbeat = true.
         void asyncHeartbeat();
 
         // Heartbeat information, used by asyncHeartbeat and sendHeartbeat.
-        bool heartbeat = true;
+        std::atomic<bool> heartbeat { true };
         unsigned heartbeatIntervalMs;
-        unsigned unansweredHeartbeats = 0;
+        std::atomic<unsigned> unansweredHeartbeats { 0 };
         boost::asio::steady_timer heartbeatTimer;
 
         // Send heartbeat, if we don't have answer for two heartbeats - reconnect and return.
         void sendHeartbeat();
 
         // Session information.
-        bool activeSession = false; // true if we connected and everything is working.
+        std::atomic<bool> activeSession { false }; // true if we connected and everything is working.
         std::string sessionId_, lastGatewayUrl_, token_;
         int shardId_ = NoSharding, shardCount_ = NoSharding;
-        int lastSequenceNumber_ = 0;
+        std::atomic<int> lastSequenceNumber_ { 0 };
         nlohmann::json lastPresence;
 
 
-        std::unique_ptr<TLSWebSocket> gatewayConnection;
+        // Replaced on reconnect, so accessed using std::atomic_load and
+        // std::atomic_store. Async handlers hold copy to keep socket alive
+        // and to detect that they belong to old connection.
+        std::shared_ptr<TLSWebSocket> gatewayConnection;
         boost::asio::io_service& ioService; // non-owning reference to I/O service.
 
+        // Serializes heartbeats, reads, writes and event handlers.
+        boost::asio::io_service::strand strand;
+
         static constexpr const char* gatewayPathSuffix = "/?v=6&encoding=json";
     };
 }
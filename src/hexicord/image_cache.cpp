@@ -0,0 +1,293 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/image_cache.hpp"
+
+#include <algorithm>                    // std::sort
+#include <ctime>                        // std::time
+#include <iterator>                     // std::prev, std::next
+#include <stdexcept>                    // std::runtime_error
+#include <utility>                      // std::move, std::pair
+#include "hexicord/config.hpp"          // HEXICORD_DEBUG_LOG
+#include "hexicord/internal/utils.hpp"  // Utils::split
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+    #define HEXICORD_HAVE_POSIX_FS
+
+    #include <cerrno>                   // errno
+    #include <dirent.h>                 // opendir, readdir, closedir
+    #include <fcntl.h>                  // open
+    #include <sys/stat.h>               // stat, mkdir
+    #include <sys/time.h>               // utimes
+    #include <unistd.h>                 // write, close, unlink, getpid
+    #include <cstdio>                   // std::rename
+#endif
+
+#ifdef HEXICORD_DEBUG_LOG
+    #include <iostream>
+    #define DEBUG_MSG(msg) do { std::cerr << "image_cache.cpp:" << __LINE__ << "\t" << (msg) << '\n'; } while (false)
+#else
+    #define DEBUG_MSG(msg)
+#endif
+
+namespace Hexicord {
+    namespace {
+        const std::string tempSuffix = ".tmp";
+
+        bool isSafeSegment(const std::string& segment) {
+            if (segment.empty() || segment == "." || segment == "..") return false;
+            for (char ch : segment) {
+                bool allowed = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+                               (ch >= '0' && ch <= '9') || ch == '.' || ch == '_' || ch == '-';
+                if (!allowed) return false;
+            }
+            return true;
+        }
+
+        bool endsWith(const std::string& str, const std::string& suffix) {
+            return str.size() >= suffix.size() &&
+                   str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+        }
+
+#ifdef HEXICORD_HAVE_POSIX_FS
+        bool makeDirectory(const std::string& path) {
+            return ::mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+        }
+
+        bool writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+            int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) return false;
+
+            size_t written = 0;
+            while (written < bytes.size()) {
+                ssize_t result = ::write(fd, bytes.data() + written, bytes.size() - written);
+                if (result < 0 && errno == EINTR) continue;
+                if (result < 0) break;
+                written += size_t(result);
+            }
+            return ::close(fd) == 0 && written == bytes.size();
+        }
+#endif
+    } // namespace
+
+    ImageCache::ImageCache(const std::string& directory, uint64_t maxBytes)
+        : directory(directory)
+        , maxBytes(maxBytes) {
+
+#ifdef HEXICORD_HAVE_POSIX_FS
+        std::string current = (!directory.empty() && directory[0] == '/') ? "/" : "";
+        for (const std::string& segment : Utils::split(directory, '/')) {
+            if (segment.empty()) continue;
+            current += segment + "/";
+            if (!makeDirectory(current)) {
+                throw std::runtime_error(std::string("Failed to create cache directory: ") + directory);
+            }
+        }
+
+        std::vector<std::pair<Entry, int64_t>> found;
+        scan("", found);
+
+        // Restore LRU order from modification times, lookup updates them.
+        std::sort(found.begin(), found.end(), [](const std::pair<Entry, int64_t>& lhs,
+                                                 const std::pair<Entry, int64_t>& rhs) {
+            return lhs.second < rhs.second;
+        });
+        for (const auto& entry : found) add(entry.first.relativePath, entry.first.size);
+
+        // Limit may be lower than in previous run.
+        while (used > maxBytes) erase(std::prev(entries.end()), true);
+
+        DEBUG_MSG(std::string("Loaded ") + std::to_string(entries.size()) + " cached images, " +
+                  std::to_string(used) + " bytes.");
+#else
+        throw std::runtime_error("ImageCache is not supported on this platform.");
+#endif
+    }
+
+    boost::optional<File> ImageCache::lookup(const std::string& cdnPath) {
+        std::string relativePath = entryPath(cdnPath);
+        if (relativePath.empty()) return boost::none;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::string fullPath = directory + "/" + relativePath;
+
+        auto it = index.find(relativePath);
+        if (it == index.end()) {
+            // May be stored by other process (shard) after directory was scanned.
+            try {
+                File file(fullPath);
+
+                add(relativePath, file.size());
+                // New entry is in front, so it's evicted only if it's the only one left.
+                while (used > maxBytes && std::next(entries.begin()) != entries.end()) {
+                    erase(std::prev(entries.end()), true);
+                }
+#ifdef HEXICORD_HAVE_POSIX_FS
+                ::utimes(fullPath.c_str(), nullptr);
+#endif
+                return file;
+            } catch (std::runtime_error&) {
+                return boost::none;
+            }
+        }
+
+        try {
+            File file(fullPath);
+
+            entries.splice(entries.begin(), entries, it->second);
+#ifdef HEXICORD_HAVE_POSIX_FS
+            // Keep recency across restarts.
+            ::utimes(fullPath.c_str(), nullptr);
+#endif
+            return file;
+        } catch (std::runtime_error&) {
+            // Removed by someone else.
+            erase(it->second, false);
+            return boost::none;
+        }
+    }
+
+    File ImageCache::store(const std::string& cdnPath, std::vector<uint8_t>&& bytes) {
+        std::string relativePath = entryPath(cdnPath);
+        std::string filename = Utils::split(Utils::split(cdnPath, '?').front(), '/').back();
+
+#ifdef HEXICORD_HAVE_POSIX_FS
+        if (!relativePath.empty() && bytes.size() <= maxBytes) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            std::string current = directory;
+            std::vector<std::string> segments = Utils::split(relativePath, '/');
+            for (size_t i = 0; i + 1 < segments.size(); ++i) {
+                current += "/" + segments[i];
+                makeDirectory(current);
+            }
+
+            std::string fullPath = directory + "/" + relativePath;
+            std::string tempPath = fullPath + "." + std::to_string(::getpid()) + "." +
+                                   std::to_string(tempCounter++) + tempSuffix;
+
+            // Rename is atomic, so readers see either nothing or whole file.
+            if (writeFile(tempPath, bytes) && std::rename(tempPath.c_str(), fullPath.c_str()) == 0) {
+                auto it = index.find(relativePath);
+                if (it != index.end()) erase(it->second, false);
+                add(relativePath, bytes.size());
+
+                while (used > maxBytes) erase(std::prev(entries.end()), true);
+            } else {
+                DEBUG_MSG(std::string("Failed to write cache entry: ") + fullPath);
+                ::unlink(tempPath.c_str());
+            }
+        }
+#endif
+
+        return File(filename, std::move(bytes));
+    }
+
+    void ImageCache::clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!entries.empty()) erase(entries.begin(), true);
+    }
+
+    uint64_t ImageCache::usedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return used;
+    }
+
+    std::string ImageCache::entryPath(const std::string& cdnPath) {
+        // /avatars/{id}/{hash}.png?size=2048 -> avatars/{id}/2048/{hash}.png
+        std::vector<std::string> pathAndQuery = Utils::split(cdnPath, '?');
+        std::vector<std::string> segments = Utils::split(pathAndQuery.front(), '/');
+
+        std::string size = "original";
+        if (pathAndQuery.size() > 1) {
+            for (const std::string& variable : Utils::split(pathAndQuery[1], '&')) {
+                if (variable.compare(0, 5, "size=") == 0) size = variable.substr(5);
+            }
+        }
+        if (!isSafeSegment(size)) return "";
+
+        std::string result;
+        for (size_t i = 0; i < segments.size(); ++i) {
+            if (segments[i].empty()) continue;
+            if (!isSafeSegment(segments[i]) || endsWith(segments[i], tempSuffix)) return "";
+
+            if (i + 1 == segments.size()) result += size + "/";
+            result += segments[i];
+            if (i + 1 != segments.size()) result += "/";
+        }
+        return result;
+    }
+
+    void ImageCache::scan(const std::string& relativeDirectory, std::vector<std::pair<Entry, int64_t>>& found) {
+#ifdef HEXICORD_HAVE_POSIX_FS
+        std::string fullDirectory = directory + "/" + relativeDirectory;
+
+        DIR* dir = ::opendir(fullDirectory.c_str());
+        if (!dir) return;
+
+        while (dirent* entry = ::readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") continue;
+
+            std::string relativePath = relativeDirectory.empty() ? name : relativeDirectory + "/" + name;
+            std::string fullPath = directory + "/" + relativePath;
+
+            struct stat info;
+            if (::stat(fullPath.c_str(), &info) != 0) continue;
+
+            if (S_ISDIR(info.st_mode)) {
+                scan(relativePath, found);
+            } else if (S_ISREG(info.st_mode)) {
+                if (endsWith(name, tempSuffix)) {
+                    // Old temporary files are left by process that crashed while
+                    // writing, fresh ones may be written by other process right now.
+                    if (std::time(nullptr) - info.st_mtime > 60 * 60) ::unlink(fullPath.c_str());
+                    continue;
+                }
+                found.push_back({ Entry{ relativePath, uint64_t(info.st_size) }, int64_t(info.st_mtime) });
+            }
+        }
+        ::closedir(dir);
+#else
+        (void)relativeDirectory;
+        (void)found;
+#endif
+    }
+
+    void ImageCache::erase(std::list<Entry>::iterator it, bool removeFile) {
+#ifdef HEXICORD_HAVE_POSIX_FS
+        if (removeFile) ::unlink((directory + "/" + it->relativePath).c_str());
+#else
+        (void)removeFile;
+#endif
+        used -= it->size;
+        index.erase(it->relativePath);
+        entries.erase(it);
+    }
+
+    void ImageCache::add(const std::string& relativePath, uint64_t size) {
+        entries.push_front({ relativePath, size });
+        index.emplace(relativePath, entries.begin());
+        used += size;
+    }
+} // namespace Hexicord
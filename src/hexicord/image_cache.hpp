@@ -0,0 +1,117 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_IMAGE_CACHE_HPP
+#define HEXICORD_IMAGE_CACHE_HPP
+
+#include <cstdint>                      // uint8_t, uint64_t
+#include <list>                         // std::list
+#include <mutex>                        // std::mutex
+#include <string>                       // std::string
+#include <unordered_map>                // std::unordered_map
+#include <vector>                       // std::vector
+#include <boost/optional.hpp>           // boost::optional
+#include "hexicord/types/file.hpp"      // Hexicord::File
+
+namespace Hexicord {
+    /**
+     * On-disk cache for files downloaded from CDN.
+     *
+     * CDN paths include image hash, so contents for same path never
+     * changes and entries never expire, they are only evicted (least
+     * recently used first) when size limit is reached.
+     *
+     * Entry is stored at path derived from CDN path, like
+     * `{directory}/avatars/{user_id}/{size}/{hash}.png`. Entries are
+     * written to temporary file first and then renamed, so other
+     * processes (shards) sharing directory never see partial files, and
+     * entries stored by them are found by \ref lookup too. Cache hits are
+     * returned as memory-mapped \ref File.
+     *
+     * Enable it by assigning instance to \ref CdnClient::cache.
+     *
+     * All methods are thread-safe. Only POSIX systems are supported.
+     */
+    class ImageCache {
+    public:
+        /**
+         * Open cache in directory (created if doesn't exists).
+         * Existing entries are scanned to restore usage information,
+         * least recently used ones are removed if they exceed maxBytes.
+         *
+         * \param maxBytes Upper bound of total entries size. It's tracked
+         *                 per process, so it may be exceeded a bit if
+         *                 several processes share directory.
+         *
+         * \throws std::runtime_error if directory can't be created.
+         */
+        explicit ImageCache(const std::string& directory, uint64_t maxBytes = 256 * 1024 * 1024);
+
+        /**
+         * Get cached file for CDN path (with query string).
+         */
+        boost::optional<File> lookup(const std::string& cdnPath);
+
+        /**
+         * Store downloaded file, errors are ignored since cache is optional.
+         *
+         * \returns File with passed contents.
+         */
+        File store(const std::string& cdnPath, std::vector<uint8_t>&& bytes);
+
+        /**
+         * Remove all entries.
+         */
+        void clear();
+
+        /**
+         * Total size of entries in bytes.
+         */
+        uint64_t usedBytes() const;
+
+        const std::string directory;
+        const uint64_t maxBytes;
+    private:
+        struct Entry {
+            std::string relativePath;
+            uint64_t size;
+        };
+
+        // CDN path -> path relative to cache directory, empty string if
+        // path can't be cached.
+        static std::string entryPath(const std::string& cdnPath);
+
+        void scan(const std::string& relativeDirectory, std::vector<std::pair<Entry, int64_t>>& found);
+        void erase(std::list<Entry>::iterator it, bool removeFile);
+        void add(const std::string& relativePath, uint64_t size);
+
+        // Most recently used entry is in front.
+        std::list<Entry> entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        uint64_t used = 0;
+        uint64_t tempCounter = 0;
+
+        mutable std::mutex mutex;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_IMAGE_CACHE_HPP
@@ -0,0 +1,165 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/internal/utils.hpp"
+
+#include <cstring>      // std::memcpy
+
+// SIMD paths are compiled using target attributes and selected at runtime, so
+// library works on any x86 CPU without special compiler flags.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define HEXICORD_BASE64_X86
+    #include <immintrin.h>  // SSSE3, AVX2 intrinsics
+#endif
+
+namespace Hexicord { namespace Utils {
+    namespace {
+        const char Base64Map[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        // Encodes whole 3-byte groups and padded tail.
+        void encodeScalar(const uint8_t* data, size_t size, char* output) {
+            size_t i = 0;
+            for (; i + 3 <= size; i += 3) {
+                uint32_t group = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+                *output++ = Base64Map[(group >> 18) & 0x3f];
+                *output++ = Base64Map[(group >> 12) & 0x3f];
+                *output++ = Base64Map[(group >> 6)  & 0x3f];
+                *output++ = Base64Map[group         & 0x3f];
+            }
+
+            if (size - i == 1) {
+                uint32_t group = uint32_t(data[i]) << 16;
+                *output++ = Base64Map[(group >> 18) & 0x3f];
+                *output++ = Base64Map[(group >> 12) & 0x3f];
+                *output++ = '=';
+                *output++ = '=';
+            } else if (size - i == 2) {
+                uint32_t group = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8);
+                *output++ = Base64Map[(group >> 18) & 0x3f];
+                *output++ = Base64Map[(group >> 12) & 0x3f];
+                *output++ = Base64Map[(group >> 6)  & 0x3f];
+                *output++ = '=';
+            }
+        }
+
+#ifdef HEXICORD_BASE64_X86
+        // Vector code follows W. Muła, D. Lemire, "Faster Base64 Encoding and
+        // Decoding Using AVX2 Instructions": bytes are shuffled so each 32-bit
+        // lane holds one 3-byte group, 6-bit indices are extracted using
+        // multiplications and mapped to ASCII by adding per-range offset.
+
+        __attribute__((target("ssse3")))
+        inline __m128i unpackSSSE3(__m128i in) {
+            in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+            const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+            const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+            const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+            const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+            return _mm_or_si128(t1, t3);
+        }
+
+        __attribute__((target("ssse3")))
+        inline __m128i lookupSSSE3(__m128i indices) {
+            const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                  '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                                  '/' - 63, 'A', 0, 0);
+
+            // 0..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12, then 0..25 -> 13.
+            __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+            range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+
+            return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+        }
+
+        __attribute__((target("ssse3")))
+        void encodeSSSE3(const uint8_t* data, size_t size, char* output) {
+            // Each step reads 16 bytes but consumes only 12.
+            size_t i = 0;
+            for (; i + 16 <= size; i += 12, output += 16) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output), lookupSSSE3(unpackSSSE3(in)));
+            }
+            encodeScalar(data + i, size - i, output);
+        }
+
+        __attribute__((target("avx2")))
+        void encodeAVX2(const uint8_t* data, size_t size, char* output) {
+            const __m256i shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                                    10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+            const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                     '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                                     '/' - 63, 'A', 0, 0,
+                                                     'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                     '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                                     '/' - 63, 'A', 0, 0);
+
+            // Each step consumes 24 bytes, 12 per 128-bit lane, and reads 28.
+            size_t i = 0;
+            for (; i + 28 <= size; i += 24, output += 32) {
+                const __m128i low  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 12));
+                __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+
+                in = _mm256_shuffle_epi8(in, shuffle);
+
+                const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+                const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+                const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+                const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+                const __m256i indices = _mm256_or_si256(t1, t3);
+
+                __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+                const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+                range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+                const __m256i result = _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range));
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), result);
+            }
+            encodeSSSE3(data + i, size - i, output);
+        }
+#endif // HEXICORD_BASE64_X86
+
+        using EncodeFunction = void(*)(const uint8_t*, size_t, char*);
+
+        EncodeFunction selectEncoder() {
+#ifdef HEXICORD_BASE64_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))  return encodeAVX2;
+            if (__builtin_cpu_supports("ssse3")) return encodeSSSE3;
+#endif
+            return encodeScalar;
+        }
+    } // namespace
+
+    void base64Encode(const uint8_t* data, size_t size, char* output) {
+        static const EncodeFunction encode = selectEncoder();
+        encode(data, size, output);
+    }
+
+    std::string base64Encode(const uint8_t* data, size_t size) {
+        std::string result(base64EncodedSize(size), '\0');
+        base64Encode(data, size, &result[0]);
+        return result;
+    }
+}} // namespace Hexicord::Utils
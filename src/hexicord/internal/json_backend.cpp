@@ -0,0 +1,140 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/internal/json_backend.hpp"
+
+#include "hexicord/config.hpp"                    // HEXICORD_JSON_SIMDJSON
+
+#ifdef HEXICORD_JSON_SIMDJSON
+    #include <cstdint>                            // int64_t
+    #include <cstring>                            // std::memcpy
+    #include <vector>                             // std::vector
+    #include <simdjson.h>                         // simdjson::ondemand
+#else
+    #include "hexicord/internal/json_reader.hpp"  // Hexicord::JsonReader
+#endif
+
+namespace Hexicord { namespace JsonBackend {
+#ifdef HEXICORD_JSON_SIMDJSON
+    namespace {
+        // Parser keeps its internal buffers between documents, so
+        // steady-state parsing doesn't allocate. One per thread because
+        // gateway messages may be handled by several io_service threads.
+        thread_local simdjson::ondemand::parser ondemandParser;
+
+        // simdjson reads past end of input, so it's copied into buffer
+        // with required padding. Copy is cheap compared to parsing.
+        thread_local std::vector<char> paddedInput;
+
+        const char* pad(boost::string_view text) {
+            if (paddedInput.size() < text.size() + simdjson::SIMDJSON_PADDING) {
+                paddedInput.resize(text.size() + simdjson::SIMDJSON_PADDING);
+            }
+            std::memcpy(paddedInput.data(), text.data(), text.size());
+            return paddedInput.data();
+        }
+
+        [[noreturn]] void fail(simdjson::error_code error) {
+            throw nlohmann::json::parse_error::create(101, 0, simdjson::error_message(error));
+        }
+
+        // Views returned by on-demand parser point into padded copy,
+        // translate them back into original text.
+        template<typename View>
+        boost::string_view translate(View view, const char* padded, boost::string_view text) {
+            return text.substr(size_t(view.data() - padded), view.size());
+        }
+    } // namespace
+
+    GatewayEnvelope scanGatewayEnvelope(boost::string_view text) {
+        const char* padded = pad(text);
+        GatewayEnvelope envelope;
+
+        simdjson::ondemand::document document;
+        simdjson::error_code error = ondemandParser.iterate(padded, text.size(), paddedInput.size()).get(document);
+        if (error) fail(error);
+
+        simdjson::ondemand::object object;
+        if ((error = document.get_object().get(object))) fail(error);
+
+        for (auto field : object) {
+            std::string_view key;
+            if ((error = field.unescaped_key().get(key))) fail(error);
+            simdjson::ondemand::value value = field.value();
+
+            if (key == "op") {
+                int64_t op;
+                if ((error = value.get_int64().get(op))) fail(error);
+                envelope.op = int(op);
+            } else if (key == "s") {
+                if (!value.is_null()) {
+                    int64_t s;
+                    if ((error = value.get_int64().get(s))) fail(error);
+                    envelope.s = int(s);
+                }
+            } else if (key == "t") {
+                if (!value.is_null()) {
+                    // Raw token includes quotes, event names never contain escapes.
+                    std::string_view token = value.raw_json_token();
+                    envelope.t = translate(token, padded, text).substr(1);
+                    if (!envelope.t.empty()) envelope.t.remove_suffix(1);
+                }
+            } else if (key == "d") {
+                std::string_view raw;
+                if ((error = value.raw_json().get(raw))) fail(error);
+                envelope.d = translate(raw, padded, text);
+            }
+        }
+        return envelope;
+    }
+#else
+    GatewayEnvelope scanGatewayEnvelope(boost::string_view text) {
+        JsonReader reader(text);
+        GatewayEnvelope envelope;
+
+        reader.beginObject();
+        boost::string_view key;
+        while (reader.nextKey(key)) {
+            if (key == "op") {
+                envelope.op = int(reader.readInt());
+            } else if (key == "s") {
+                envelope.s = int(reader.readInt());
+            } else if (key == "t") {
+                // Event names never contain escape sequences, so just strip quotes.
+                envelope.t = reader.readNull() ? boost::string_view() : reader.readRaw().substr(1);
+                if (!envelope.t.empty()) envelope.t.remove_suffix(1);
+            } else if (key == "d") {
+                envelope.d = reader.readRaw();
+            } else {
+                reader.skip();
+            }
+        }
+        return envelope;
+    }
+#endif
+
+    // Same for both backends: building nlohmann::json from simdjson DOM is
+    // more work than parsing text with nlohmann directly.
+    nlohmann::json parse(boost::string_view text) {
+        return nlohmann::json::parse(text.begin(), text.end());
+    }
+}} // namespace Hexicord::JsonBackend
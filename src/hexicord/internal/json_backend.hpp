@@ -0,0 +1,69 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#ifndef HEXICORD_JSON_BACKEND_HPP
+#define HEXICORD_JSON_BACKEND_HPP
+
+#include <cstddef>                          // size_t
+#include <boost/utility/string_view.hpp>    // boost::string_view
+#include "hexicord/json.hpp"                // nlohmann::json
+
+/**
+ * \file json_backend.hpp
+ *
+ * Parsing of inbound JSON on hot paths (gateway messages and REST responses).
+ *
+ * Implementation is selected by HEXICORD_JSON_BACKEND CMake option:
+ * - nlohmann (default) - bundled json.hpp and JsonReader.
+ * - simdjson - simdjson on-demand parser for envelope scan.
+ *
+ * \ref parse uses nlohmann parser with both backends: converting simdjson DOM
+ * into nlohmann::json costs more than parsing text directly. DOM is built
+ * only when nlohmann::json is really needed, typed and raw handlers and
+ * \ref RestClient::sendTypedRequest skip it.
+ *
+ * Both throw nlohmann::json::parse_error on malformed input, so callers don't
+ * depend on backend.
+ */
+
+namespace Hexicord {
+    namespace JsonBackend {
+        /// Parse text into nlohmann::json.
+        nlohmann::json parse(boost::string_view text);
+
+        /// Fields of gateway message, views point into scanned text.
+        struct GatewayEnvelope {
+            int op = -1;
+            int s = 0;
+            /// Event name, empty if null or missing.
+            boost::string_view t;
+            /// Raw JSON text of payload, empty if missing.
+            boost::string_view d;
+        };
+
+        /// Read envelope fields without parsing payload.
+        GatewayEnvelope scanGatewayEnvelope(boost::string_view text);
+    } // namespace JsonBackend
+} // namespace Hexicord
+
+#endif // HEXICORD_JSON_BACKEND_HPP
@@ -0,0 +1,389 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/internal/json_reader.hpp"
+
+#include <cstdlib>              // std::strtod
+#include <cstring>              // std::memcmp
+#include <limits>               // std::numeric_limits
+#include "hexicord/json.hpp"    // nlohmann::json::parse_error
+
+namespace Hexicord {
+    namespace {
+        inline bool isWhitespace(char c) {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        inline bool isDelimiter(char c) {
+            return isWhitespace(c) || c == ',' || c == ':' || c == '"' ||
+                   c == '[' || c == ']' || c == '{' || c == '}';
+        }
+
+        int hexDigit(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        void appendUtf8(std::string& out, uint32_t codepoint) {
+            if (codepoint < 0x80) {
+                out += char(codepoint);
+            } else if (codepoint < 0x800) {
+                out += char(0xC0 | (codepoint >> 6));
+                out += char(0x80 | (codepoint & 0x3F));
+            } else if (codepoint < 0x10000) {
+                out += char(0xE0 | (codepoint >> 12));
+                out += char(0x80 | ((codepoint >> 6) & 0x3F));
+                out += char(0x80 | (codepoint & 0x3F));
+            } else {
+                out += char(0xF0 | (codepoint >> 18));
+                out += char(0x80 | ((codepoint >> 12) & 0x3F));
+                out += char(0x80 | ((codepoint >> 6) & 0x3F));
+                out += char(0x80 | (codepoint & 0x3F));
+            }
+        }
+    } // namespace
+
+    JsonReader::JsonReader(const char* begin, const char* end)
+        : begin(begin), pos(begin), end(end) {}
+
+    JsonReader::JsonReader(boost::string_view text)
+        : JsonReader(text.data(), text.data() + text.size()) {}
+
+    void JsonReader::error(const char* message) const {
+        throw nlohmann::json::parse_error::create(101, size_t(pos - begin) + 1, message);
+    }
+
+    void JsonReader::skipWhitespace() {
+        while (pos != end && isWhitespace(*pos)) ++pos;
+    }
+
+    void JsonReader::expect(char c) {
+        skipWhitespace();
+        if (pos == end || *pos != c) error("unexpected character");
+        ++pos;
+    }
+
+    JsonReader::Type JsonReader::peek() {
+        skipWhitespace();
+        if (pos == end) error("unexpected end of input");
+
+        switch (*pos) {
+        case '{': return Type::Object;
+        case '[': return Type::Array;
+        case '"': return Type::String;
+        case 't':
+        case 'f': return Type::Bool;
+        case 'n': return Type::Null;
+        default:
+            if (*pos == '-' || (*pos >= '0' && *pos <= '9')) return Type::Number;
+            error("unexpected character");
+        }
+    }
+
+    bool JsonReader::atEnd() {
+        skipWhitespace();
+        return pos == end;
+    }
+
+    void JsonReader::beginObject() {
+        expect('{');
+        afterOpen = true;
+    }
+
+    bool JsonReader::nextKey(boost::string_view& key) {
+        skipWhitespace();
+        if (pos != end && *pos == '}') {
+            ++pos;
+            afterOpen = false;
+            return false;
+        }
+        if (!afterOpen) expect(',');
+        afterOpen = false;
+
+        expect('"');
+        const char* start = pos;
+        while (pos != end && *pos != '"') {
+            if (*pos == '\\' && ++pos == end) break;
+            ++pos;
+        }
+        if (pos == end) error("unterminated string");
+        key = boost::string_view(start, size_t(pos - start));
+        ++pos;
+
+        expect(':');
+        return true;
+    }
+
+    void JsonReader::beginArray() {
+        expect('[');
+        afterOpen = true;
+    }
+
+    bool JsonReader::nextElement() {
+        skipWhitespace();
+        if (pos != end && *pos == ']') {
+            ++pos;
+            afterOpen = false;
+            return false;
+        }
+        if (!afterOpen) expect(',');
+        afterOpen = false;
+        return true;
+    }
+
+    bool JsonReader::readNull() {
+        skipWhitespace();
+        if (end - pos >= 4 && std::memcmp(pos, "null", 4) == 0) {
+            pos += 4;
+            afterOpen = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool JsonReader::readBool() {
+        if (readNull()) return false;
+
+        afterOpen = false;
+        if (end - pos >= 4 && std::memcmp(pos, "true", 4) == 0) {
+            pos += 4;
+            return true;
+        }
+        if (end - pos >= 5 && std::memcmp(pos, "false", 5) == 0) {
+            pos += 5;
+            return false;
+        }
+        error("expected boolean");
+    }
+
+    boost::string_view JsonReader::scanNumber() {
+        skipWhitespace();
+        const char* start = pos;
+        while (pos != end && ((*pos >= '0' && *pos <= '9') || *pos == '-' || *pos == '+' ||
+                              *pos == '.' || *pos == 'e' || *pos == 'E')) {
+            ++pos;
+        }
+        if (pos == start) error("expected number");
+        afterOpen = false;
+        return boost::string_view(start, size_t(pos - start));
+    }
+
+    uint64_t JsonReader::readUInt() {
+        if (readNull()) return 0;
+
+        boost::string_view number = scanNumber();
+        if (number.find_first_of(".eE-") != boost::string_view::npos) {
+            double value = readDoubleFrom(number);
+            return value < 0 ? 0 : uint64_t(value);
+        }
+
+        uint64_t result = 0;
+        for (char c : number) {
+            if (c < '0' || c > '9') error("invalid number");
+            unsigned digit = unsigned(c - '0');
+            if (result > (std::numeric_limits<uint64_t>::max() - digit) / 10) error("number is out of range");
+            result = result * 10 + digit;
+        }
+        return result;
+    }
+
+    int64_t JsonReader::readInt() {
+        skipWhitespace();
+        if (pos != end && *pos == '-') {
+            ++pos;
+            uint64_t magnitude = readUInt();
+            if (magnitude > uint64_t(std::numeric_limits<int64_t>::max()) + 1) error("number is out of range");
+            return magnitude == uint64_t(std::numeric_limits<int64_t>::max()) + 1 ? std::numeric_limits<int64_t>::min()
+                                                                                  : -int64_t(magnitude);
+        }
+
+        uint64_t value = readUInt();
+        if (value > uint64_t(std::numeric_limits<int64_t>::max())) error("number is out of range");
+        return int64_t(value);
+    }
+
+    double JsonReader::readDoubleFrom(boost::string_view number) const {
+        // strtod needs null-terminated string and JSON numbers are short anyway.
+        char buffer[64];
+        if (number.size() >= sizeof(buffer)) error("number is too long");
+        std::memcpy(buffer, number.data(), number.size());
+        buffer[number.size()] = '\0';
+
+        char* parsedEnd;
+        double result = std::strtod(buffer, &parsedEnd);
+        if (parsedEnd != buffer + number.size()) error("invalid number");
+        return result;
+    }
+
+    double JsonReader::readDouble() {
+        if (readNull()) return 0.0;
+        return readDoubleFrom(scanNumber());
+    }
+
+    Snowflake JsonReader::readSnowflake() {
+        if (readNull()) return Snowflake();
+
+        bool quoted = pos != end && *pos == '"';
+        if (quoted) ++pos;
+
+        const char* start = pos;
+        uint64_t value = 0;
+        while (pos != end && *pos >= '0' && *pos <= '9') {
+            unsigned digit = unsigned(*pos - '0');
+            if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10) error("snowflake is out of range");
+            value = value * 10 + digit;
+            ++pos;
+        }
+        if (pos == start) error("invalid snowflake");
+
+        if (quoted) {
+            if (pos == end || *pos != '"') error("invalid snowflake");
+            ++pos;
+        }
+        afterOpen = false;
+        return Snowflake(value);
+    }
+
+    std::string JsonReader::readString() {
+        if (readNull()) return std::string();
+
+        expect('"');
+        afterOpen = false;
+
+        // Fast path: most strings don't have escape sequences at all.
+        const char* start = pos;
+        while (pos != end && *pos != '"' && *pos != '\\') ++pos;
+        if (pos == end) error("unterminated string");
+        std::string result(start, pos);
+
+        while (*pos != '"') {
+            if (*pos != '\\') {
+                const char* chunk = pos;
+                while (pos != end && *pos != '"' && *pos != '\\') ++pos;
+                result.append(chunk, pos);
+                if (pos == end) error("unterminated string");
+                continue;
+            }
+
+            if (++pos == end) error("unterminated string");
+            switch (*pos++) {
+            case '"':  result += '"';  break;
+            case '\\': result += '\\'; break;
+            case '/':  result += '/';  break;
+            case 'b':  result += '\b'; break;
+            case 'f':  result += '\f'; break;
+            case 'n':  result += '\n'; break;
+            case 'r':  result += '\r'; break;
+            case 't':  result += '\t'; break;
+            case 'u':
+            {
+                uint32_t codepoint = readHex4();
+                if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                    if (end - pos < 2 || pos[0] != '\\' || pos[1] != 'u') error("unpaired surrogate");
+                    pos += 2;
+                    uint32_t low = readHex4();
+                    if (low < 0xDC00 || low > 0xDFFF) error("unpaired surrogate");
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(result, codepoint);
+                break;
+            }
+            default:
+                error("invalid escape sequence");
+            }
+            if (pos == end) error("unterminated string");
+        }
+        ++pos;
+        return result;
+    }
+
+    uint32_t JsonReader::readHex4() {
+        if (end - pos < 4) error("invalid unicode escape");
+
+        uint32_t result = 0;
+        for (int i = 0; i < 4; ++i) {
+            int digit = hexDigit(*pos++);
+            if (digit < 0) error("invalid unicode escape");
+            result = (result << 4) | uint32_t(digit);
+        }
+        return result;
+    }
+
+    void JsonReader::skipString() {
+        // Assumes pos is at opening quote.
+        ++pos;
+        while (pos != end && *pos != '"') {
+            if (*pos == '\\' && ++pos == end) break;
+            ++pos;
+        }
+        if (pos == end) error("unterminated string");
+        ++pos;
+    }
+
+    void JsonReader::skip() {
+        skipWhitespace();
+        unsigned depth = 0;
+        do {
+            if (pos == end) error("unexpected end of input");
+
+            switch (*pos) {
+            case '{':
+            case '[':
+                ++depth;
+                ++pos;
+                break;
+            case '}':
+            case ']':
+                if (depth == 0) error("unexpected closing bracket");
+                --depth;
+                ++pos;
+                break;
+            case '"':
+                skipString();
+                break;
+            case ',':
+            case ':':
+                if (depth == 0) error("unexpected separator");
+                ++pos;
+                break;
+            default:
+                if (isWhitespace(*pos)) {
+                    ++pos;
+                } else {
+                    // Number or literal.
+                    while (pos != end && !isDelimiter(*pos)) ++pos;
+                }
+            }
+        } while (depth != 0);
+
+        afterOpen = false;
+    }
+
+    boost::string_view JsonReader::readRaw() {
+        skipWhitespace();
+        const char* start = pos;
+        skip();
+        return boost::string_view(start, size_t(pos - start));
+    }
+} // namespace Hexicord
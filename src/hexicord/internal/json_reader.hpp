@@ -0,0 +1,124 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_JSON_READER_HPP
+#define HEXICORD_JSON_READER_HPP
+
+#include <cstdint>                          // uint64_t, int64_t, uint32_t
+#include <string>                           // std::string
+#include <boost/utility/string_view.hpp>    // boost::string_view
+#include "hexicord/types/snowflake.hpp"     // Hexicord::Snowflake
+
+namespace Hexicord {
+    /**
+     * Pull parser over JSON text that never builds DOM. Caller walks document
+     * in order and skips what it doesn't need:
+     *
+     * ```cpp
+     * JsonReader reader(text);
+     * reader.beginObject();
+     * boost::string_view key;
+     * while (reader.nextKey(key)) {
+     *     if (key == "id") id = reader.readSnowflake();
+     *     else reader.skip();
+     * }
+     * ```
+     *
+     * null is accepted by all read* methods and results in default value.
+     * Malformed input causes nlohmann::json::parse_error, same as with
+     * nlohmann::json::parse.
+     *
+     * Input must outlive reader, returned keys and raw views point into it.
+     */
+    class JsonReader {
+    public:
+        enum class Type {
+            Null,
+            Bool,
+            Number,
+            String,
+            Object,
+            Array
+        };
+
+        JsonReader(const char* begin, const char* end);
+        explicit JsonReader(boost::string_view text);
+
+        /// Type of next value.
+        Type peek();
+
+        /// True if whole input is consumed (except whitespace).
+        bool atEnd();
+
+        void beginObject();
+
+        /**
+         * Read next key of current object.
+         *
+         * \returns false and consumes closing brace if there are no more
+         *          keys. Escape sequences in keys are not decoded.
+         */
+        bool nextKey(boost::string_view& key);
+
+        void beginArray();
+
+        /// \returns false and consumes closing bracket if array is over.
+        bool nextElement();
+
+        bool        readBool();
+        int64_t     readInt();
+        uint64_t    readUInt();
+        double      readDouble();
+        std::string readString();
+
+        /// Accepts both string and number form, digits are converted in place.
+        Snowflake readSnowflake();
+
+        /// Skips null and returns true if next value is null, otherwise does nothing.
+        bool readNull();
+
+        /// Skip next value including all nested values.
+        void skip();
+
+        /// Skip next value and return its text.
+        boost::string_view readRaw();
+
+    private:
+        [[noreturn]] void error(const char* message) const;
+
+        void skipWhitespace();
+        void expect(char c);
+        void skipString();
+        uint32_t readHex4();
+        boost::string_view scanNumber();
+        double readDoubleFrom(boost::string_view number) const;
+
+        const char* begin;
+        const char* pos;
+        const char* end;
+
+        // Set right after { or [, so first key/element is not preceded by comma.
+        bool afterOpen = false;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_JSON_READER_HPP
@@ -0,0 +1,84 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/internal/json_writer.hpp"
+
+#include <cstdio>               // std::snprintf
+
+namespace Hexicord {
+    namespace {
+        // nlohmann's vector adapter copies through std::back_inserter
+        // byte by byte, this one appends whole chunks.
+        class BufferAdapter : public nlohmann::detail::output_adapter_protocol<char> {
+        public:
+            explicit BufferAdapter(std::vector<char>& buffer) : buffer(buffer) {}
+
+            void write_character(char c) override {
+                buffer.push_back(c);
+            }
+
+            void write_characters(const char* s, std::size_t length) override {
+                buffer.insert(buffer.end(), s, s + length);
+            }
+
+        private:
+            std::vector<char>& buffer;
+        };
+    } // namespace
+
+    struct JsonWriterState {
+        explicit JsonWriterState(std::vector<char>& buffer)
+            : serializer(std::make_shared<BufferAdapter>(buffer), ' ') {}
+
+        nlohmann::detail::serializer<nlohmann::json> serializer;
+    };
+
+    JsonWriter::JsonWriter()
+        : state(std::make_shared<JsonWriterState>(buffer)) {
+
+        buffer.reserve(512);
+    }
+
+    void JsonWriter::clear() {
+        buffer.clear();
+    }
+
+    void JsonWriter::swapBuffer(std::vector<char>& other) {
+        // Swap contents, not objects: serializer's adapter refers to buffer.
+        buffer.swap(other);
+        buffer.clear();
+    }
+
+    void JsonWriter::append(const nlohmann::json& value) {
+        state->serializer.dump(value, /* pretty_print: */ false, /* ensure_ascii: */ false, /* indent_step: */ 0);
+    }
+
+    void JsonWriter::appendRaw(boost::string_view text) {
+        buffer.insert(buffer.end(), text.begin(), text.end());
+    }
+
+    void JsonWriter::appendNumber(int64_t number) {
+        char digits[24];
+        int length = std::snprintf(digits, sizeof(digits), "%lld", static_cast<long long>(number));
+        buffer.insert(buffer.end(), digits, digits + length);
+    }
+} // namespace Hexicord
@@ -0,0 +1,82 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#ifndef HEXICORD_JSON_WRITER_HPP
+#define HEXICORD_JSON_WRITER_HPP
+
+#include <cstddef>                          // size_t
+#include <cstdint>                          // int64_t
+#include <memory>                           // std::shared_ptr
+#include <vector>                           // std::vector
+#include <boost/utility/string_view.hpp>    // boost::string_view
+#include "hexicord/json.hpp"                // nlohmann::json
+
+namespace Hexicord {
+    struct JsonWriterState;
+
+    /**
+     * Serializes JSON into buffer that is reused between messages, so
+     * once buffer grew to usual message size no allocations are done.
+     * nlohmann::json::dump allocates result string, output adapter and
+     * indentation string on every call.
+     *
+     * Values can be mixed with raw text, e.g. to write message envelope
+     * without building wrapping nlohmann::json object.
+     *
+     * Not thread-safe, not copyable.
+     */
+    class JsonWriter {
+    public:
+        JsonWriter();
+
+        JsonWriter(const JsonWriter&) = delete;
+        JsonWriter& operator=(const JsonWriter&) = delete;
+
+        /// Discard contents but keep allocated memory.
+        void clear();
+
+        /// Append serialized value (compact form, same as dump()).
+        void append(const nlohmann::json& value);
+
+        /// Append text as is.
+        void appendRaw(boost::string_view text);
+
+        void appendNumber(int64_t number);
+
+        /**
+         * Move contents to \p other and continue writing into memory of
+         * \p other (cleared). Lets caller keep serialized message without
+         * copying it, while both buffers are reused.
+         */
+        void swapBuffer(std::vector<char>& other);
+
+        inline const char* data() const { return buffer.data(); }
+        inline size_t size() const { return buffer.size(); }
+
+    private:
+        std::vector<char> buffer;
+        std::shared_ptr<JsonWriterState> state;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_JSON_WRITER_HPP
@@ -0,0 +1,103 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/internal/request_scheduler.hpp"
+
+#include <cassert>  // assert
+
+namespace Hexicord {
+    RequestScheduler::RequestScheduler(unsigned slots, const std::vector<unsigned>& weights)
+        : waiting(weights.size())
+        , weights(weights)
+        , credits(weights) {
+
+        assert(slots != 0);
+        for (unsigned weight : weights) {
+            assert(weight != 0);
+        }
+        for (unsigned i = slots; i != 0; --i) {
+            freeSlots.push_back(i - 1);
+        }
+    }
+
+    unsigned RequestScheduler::acquire(unsigned priorityClass) {
+        assert(priorityClass < waiting.size());
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        const uint64_t ticket = nextTicket++;
+        waiting[priorityClass].push_back(ticket);
+        dispatch();
+
+        decltype(granted)::iterator it;
+        grantedCondition.wait(lock, [&]() {
+            it = granted.find(ticket);
+            return it != granted.end();
+        });
+
+        unsigned slot = it->second;
+        granted.erase(it);
+        return slot;
+    }
+
+    void RequestScheduler::release(unsigned slot) {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeSlots.push_back(slot);
+        dispatch();
+    }
+
+    void RequestScheduler::dispatch() {
+        bool grantedAny = false;
+        while (!freeSlots.empty()) {
+            bool anyWaiting = false;
+            for (const auto& queue : waiting) {
+                if (!queue.empty()) {
+                    anyWaiting = true;
+                    break;
+                }
+            }
+            if (!anyWaiting) break;
+
+            auto& queue = waiting[pickClass()];
+            granted.insert({ queue.front(), freeSlots.back() });
+            queue.pop_front();
+            freeSlots.pop_back();
+            grantedAny = true;
+        }
+
+        if (grantedAny) grantedCondition.notify_all();
+    }
+
+    unsigned RequestScheduler::pickClass() {
+        while (true) {
+            for (unsigned i = 0; i < waiting.size(); ++i) {
+                if (!waiting[i].empty() && credits[i] != 0) {
+                    --credits[i];
+                    return i;
+                }
+            }
+
+            // Every waiting class used it's turns in this round, start new one.
+            credits = weights;
+        }
+    }
+} // namespace Hexicord
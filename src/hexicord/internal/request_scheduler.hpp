@@ -0,0 +1,102 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_REQUEST_SCHEDULER_HPP
+#define HEXICORD_REQUEST_SCHEDULER_HPP
+
+#include <cstdint>              // uint64_t
+#include <condition_variable>   // std::condition_variable
+#include <deque>                // std::deque
+#include <mutex>                // std::mutex
+#include <unordered_map>        // std::unordered_map
+#include <vector>               // std::vector
+
+namespace Hexicord {
+    /**
+     * Hands out connection slots to waiting requests, ordered by
+     * priority class.
+     *
+     * Classes are numbered from 0 (served first). Weighted round-robin
+     * is used when several classes are waiting: class N gets weights[N]
+     * turns before lower classes are skipped again, so background work
+     * still progresses under constant high-priority load.
+     */
+    class RequestScheduler {
+    public:
+        /**
+         * \param slots   Count of requests that can be performed at once
+         *                (connection pool size).
+         * \param weights Turns per round for each priority class.
+         */
+        RequestScheduler(unsigned slots, const std::vector<unsigned>& weights);
+
+        /**
+         * Block until slot is available for request of specified class.
+         *
+         * \returns Index of acquired slot in range [0, slots).
+         */
+        unsigned acquire(unsigned priorityClass);
+
+        /**
+         * Return slot acquired with \ref acquire.
+         */
+        void release(unsigned slot);
+
+        /**
+         * RAII wrapper for acquire/release pair.
+         */
+        class Turn {
+        public:
+            inline Turn(RequestScheduler& scheduler, unsigned priorityClass)
+                : scheduler(scheduler), slot(scheduler.acquire(priorityClass)) {}
+
+            inline ~Turn() {
+                scheduler.release(slot);
+            }
+
+            Turn(const Turn&) = delete;
+            Turn& operator=(const Turn&) = delete;
+
+            RequestScheduler& scheduler;
+            const unsigned slot;
+        };
+
+    private:
+        // Grant free slots to waiting tickets. Should be called with mutex locked.
+        void dispatch();
+
+        // Select class for next grant. Should be called with mutex locked
+        // and at least one ticket waiting.
+        unsigned pickClass();
+
+        std::mutex mutex;
+        std::condition_variable grantedCondition;
+
+        std::vector<std::deque<uint64_t>> waiting; // tickets, per class.
+        std::vector<unsigned> weights, credits;
+        std::vector<unsigned> freeSlots;
+        std::unordered_map<uint64_t, unsigned> granted; // ticket -> slot.
+        uint64_t nextTicket = 0;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_REQUEST_SCHEDULER_HPP
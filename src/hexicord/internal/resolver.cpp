@@ -0,0 +1,315 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/internal/resolver.hpp"
+
+#include <chrono>                       // std::chrono::steady_clock
+#include <memory>                       // std::shared_ptr, std::make_shared
+#include <mutex>                        // std::mutex, std::lock_guard
+#include <unordered_map>                // std::unordered_map
+#include <utility>                      // std::move
+#include <boost/asio/connect.hpp>       // boost::asio::connect
+#include "hexicord/config.hpp"          // HEXICORD_DNS_CACHE_TTL, HEXICORD_DEBUG_LOG
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+    #define HEXICORD_HAVE_POLL
+
+    #include <cerrno>                   // errno
+    #include <poll.h>                   // poll
+    #include <sys/socket.h>             // getsockopt
+#endif
+
+#ifdef HEXICORD_DEBUG_LOG
+    #include <iostream>
+    #define DEBUG_MSG(msg) do { std::cerr << "resolver.cpp:" << __LINE__ << "\t" << (msg) << '\n'; } while (false)
+#else
+    #define DEBUG_MSG(msg)
+#endif
+
+#ifndef HEXICORD_DNS_CACHE_TTL
+    #define HEXICORD_DNS_CACHE_TTL 60
+#endif
+
+using tcp = boost::asio::ip::tcp;
+
+namespace Hexicord { namespace DNS {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        // Delay before next connection attempt is started, recommended by RFC 8305.
+        constexpr int connectionAttemptDelayMs = 250;
+
+        // Background refresh not completed in this time is considered lost
+        // (nobody runs io_service), next lookup refreshes synchronously.
+        constexpr int refreshTimeoutSec = 30;
+
+        struct Entry {
+            Endpoints endpoints;
+            Clock::time_point expiresAt;
+            Clock::time_point refreshDeadline;
+            bool refreshing = false;
+        };
+
+        enum class Refresh { None, Async, Sync };
+
+        class Cache {
+        public:
+            // Returns false if there is no entry, sets refresh if entry should be refreshed.
+            bool get(const std::string& key, Endpoints& endpoints, Refresh& refresh) {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                auto it = entries.find(key);
+                if (it == entries.end()) return false;
+
+                Entry& entry = it->second;
+                const Clock::time_point now = Clock::now();
+                endpoints = entry.endpoints;
+
+                refresh = Refresh::None;
+                if (entry.expiresAt > now) return true;
+                if (entry.refreshing) {
+                    if (entry.refreshDeadline > now) return true;
+                    refresh = Refresh::Sync;
+                } else {
+                    refresh = Refresh::Async;
+                }
+
+                entry.refreshing      = true;
+                entry.refreshDeadline = now + std::chrono::seconds(refreshTimeoutSec);
+                return true;
+            }
+
+            void put(const std::string& key, Endpoints endpoints) {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                Entry& entry = entries[key];
+                entry.endpoints  = std::move(endpoints);
+                entry.expiresAt  = Clock::now() + std::chrono::seconds(HEXICORD_DNS_CACHE_TTL);
+                entry.refreshing = false;
+            }
+
+            void refreshFailed(const std::string& key) {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                auto it = entries.find(key);
+                if (it != entries.end()) it->second.refreshing = false;
+            }
+
+            void remove(const std::string& key) {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                entries.erase(key);
+            }
+
+        private:
+            std::mutex mutex;
+            std::unordered_map<std::string, Entry> entries;
+        };
+
+        Cache& cache() {
+            static Cache* instance = new Cache;
+            return *instance;
+        }
+
+        std::string cacheKey(const std::string& host, unsigned short port) {
+            return host + ":" + std::to_string(unsigned(port));
+        }
+
+        tcp::resolver::query makeQuery(const std::string& host, unsigned short port) {
+            return { host, std::to_string(unsigned(port)), tcp::resolver::query::numeric_service };
+        }
+
+        Endpoints toEndpoints(tcp::resolver::iterator it) {
+            Endpoints result;
+            for (; it != tcp::resolver::iterator(); ++it) result.push_back(it->endpoint());
+            return result;
+        }
+
+        // Alternate address families, starting with first one returned by resolver.
+        Endpoints interleaveFamilies(const Endpoints& endpoints) {
+            if (endpoints.empty()) return endpoints;
+
+            Endpoints primary, secondary;
+            bool primaryIsV6 = endpoints.front().address().is_v6();
+            for (const tcp::endpoint& endpoint : endpoints) {
+                (endpoint.address().is_v6() == primaryIsV6 ? primary : secondary).push_back(endpoint);
+            }
+
+            Endpoints result;
+            result.reserve(endpoints.size());
+            for (size_t i = 0; i < primary.size() || i < secondary.size(); ++i) {
+                if (i < primary.size())   result.push_back(primary[i]);
+                if (i < secondary.size()) result.push_back(secondary[i]);
+            }
+            return result;
+        }
+    } // namespace
+
+    Endpoints resolve(boost::asio::io_service& ioService, const std::string& host, unsigned short port) {
+        std::string key = cacheKey(host, port);
+
+        Endpoints endpoints;
+        Refresh refresh = Refresh::None;
+        if (cache().get(key, endpoints, refresh)) {
+            if (refresh == Refresh::None) return endpoints;
+            if (refresh == Refresh::Async && !ioService.stopped()) {
+                prefetch(ioService, host, port);
+                return endpoints;
+            }
+
+            // No handler can run, so refresh here. Stale entry is still
+            // better than nothing if it fails.
+            DEBUG_MSG(std::string("Refreshing ") + key + " synchronously");
+            boost::system::error_code ec;
+            tcp::resolver resolver(ioService);
+            tcp::resolver::iterator it = resolver.resolve(makeQuery(host, port), ec);
+            if (ec) {
+                DEBUG_MSG(std::string("Failed to resolve ") + key + ": " + ec.message());
+                cache().refreshFailed(key);
+                return endpoints;
+            }
+            endpoints = toEndpoints(it);
+            cache().put(key, endpoints);
+            return endpoints;
+        }
+
+        DEBUG_MSG(std::string("Resolving ") + key);
+        tcp::resolver resolver(ioService);
+        endpoints = toEndpoints(resolver.resolve(makeQuery(host, port)));
+        cache().put(key, endpoints);
+        return endpoints;
+    }
+
+    void prefetch(boost::asio::io_service& ioService, const std::string& host, unsigned short port) {
+        std::string key = cacheKey(host, port);
+        auto resolver = std::make_shared<tcp::resolver>(ioService);
+
+        resolver->async_resolve(makeQuery(host, port),
+                                [resolver, key](const boost::system::error_code& ec, tcp::resolver::iterator it) {
+            if (ec) {
+                DEBUG_MSG(std::string("Failed to resolve ") + key + ": " + ec.message());
+                cache().refreshFailed(key);
+                return;
+            }
+            cache().put(key, toEndpoints(it));
+        });
+    }
+
+    void connect(tcp::socket& socket, const Endpoints& endpoints) {
+#ifdef HEXICORD_HAVE_POLL
+        Endpoints ordered = interleaveFamilies(endpoints);
+
+        std::vector<tcp::socket> attempts;
+        attempts.reserve(ordered.size());
+        std::vector<pollfd> fds;
+        fds.reserve(ordered.size());
+
+        boost::system::error_code lastError = boost::asio::error::host_not_found;
+        size_t next = 0;
+
+        Clock::time_point nextAttemptAt = Clock::now();
+
+        while (next < ordered.size() || !attempts.empty()) {
+            if (next < ordered.size() && Clock::now() >= nextAttemptAt) {
+                attempts.emplace_back(socket.get_io_service());
+                tcp::socket& attempt = attempts.back();
+
+                boost::system::error_code ec;
+                attempt.open(ordered[next].protocol(), ec);
+                if (!ec) attempt.non_blocking(true, ec);
+                if (!ec) attempt.connect(ordered[next], ec);
+                ++next;
+
+                if (!ec) {
+                    // Connected immediately (loopback).
+                    attempt.non_blocking(false);
+                    socket = std::move(attempt);
+                    return;
+                }
+                if (ec != boost::asio::error::in_progress && ec != boost::asio::error::would_block) {
+                    lastError = ec;
+                    attempts.pop_back();
+                    continue;
+                }
+                fds.push_back({ attempt.native_handle(), POLLOUT, 0 });
+                nextAttemptAt = Clock::now() + std::chrono::milliseconds(connectionAttemptDelayMs);
+            }
+
+            // Wait for any attempt to finish, or until it's time for next one.
+            // Remaining time is recomputed, so interrupted poll doesn't start
+            // next attempt early.
+            int timeout = -1;
+            if (next < ordered.size()) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(nextAttemptAt - Clock::now()).count();
+                timeout = left > 0 ? int(left) : 0;
+            }
+            int ready = ::poll(fds.data(), nfds_t(fds.size()), timeout);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                lastError = boost::system::error_code(errno, boost::system::system_category());
+                break;
+            }
+
+            for (size_t i = 0; ready > 0 && i < fds.size();) {
+                if (fds[i].revents == 0) {
+                    ++i;
+                    continue;
+                }
+
+                int error = 0;
+                socklen_t length = sizeof(error);
+                if (::getsockopt(fds[i].fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0) error = errno;
+
+                if (error == 0) {
+                    attempts[i].non_blocking(false);
+                    socket = std::move(attempts[i]);
+                    // Other attempts are closed by destructors.
+                    return;
+                }
+
+                lastError = boost::system::error_code(error, boost::system::system_category());
+                attempts.erase(attempts.begin() + std::ptrdiff_t(i));
+                fds.erase(fds.begin() + std::ptrdiff_t(i));
+
+                // Don't wait for delay if attempt failed, RFC 8305 allows it.
+                nextAttemptAt = Clock::now();
+            }
+        }
+
+        throw boost::system::system_error(lastError);
+#else
+        boost::asio::connect(socket, endpoints.begin(), endpoints.end());
+#endif
+    }
+
+    void connect(tcp::socket& socket, const std::string& host, unsigned short port) {
+        Endpoints endpoints = resolve(socket.get_io_service(), host, port);
+        try {
+            connect(socket, endpoints);
+        } catch (boost::system::system_error& e) {
+            // Addresses may be outdated, don't reuse them.
+            DEBUG_MSG(std::string("Failed to connect to ") + host + ", dropping cached entry: " + e.what());
+            cache().remove(cacheKey(host, port));
+            throw;
+        }
+    }
+}} // namespace Hexicord::DNS
@@ -0,0 +1,77 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_RESOLVER_HPP
+#define HEXICORD_RESOLVER_HPP
+
+#include <string>                       // std::string
+#include <vector>                       // std::vector
+#include <boost/asio/io_service.hpp>    // boost::asio::io_service
+#include <boost/asio/ip/tcp.hpp>        // boost::asio::ip::tcp
+
+namespace Hexicord { namespace DNS {
+    using Endpoints = std::vector<boost::asio::ip::tcp::endpoint>;
+
+    /**
+     * Resolve host using process-wide cache.
+     *
+     * Blocks only if host was never resolved before. If cached entry
+     * is older than HEXICORD_DNS_CACHE_TTL seconds, it's still returned
+     * and refreshed in background (see \ref prefetch). If ioService is
+     * stopped or background refresh never completed, entry is refreshed
+     * synchronously instead.
+     *
+     * \throws boost::system::system_error if resolution failed.
+     */
+    Endpoints resolve(boost::asio::io_service& ioService, const std::string& host, unsigned short port);
+
+    /**
+     * Start asynchronous resolution, result is stored in cache when ready.
+     * Completes only if ioService is running.
+     */
+    void prefetch(boost::asio::io_service& ioService, const std::string& host, unsigned short port);
+
+    /**
+     * Connect socket to first endpoint that answers.
+     *
+     * Endpoints of different families are interleaved and new attempt
+     * is started every 250 ms while previous ones are still in progress
+     * ("Happy Eyeballs", RFC 8305), so dead address doesn't delay
+     * connection for whole TCP timeout. Blocks calling thread until
+     * connection is established, like rest of synchronous handshake.
+     *
+     * \throws boost::system::system_error if all attempts failed.
+     */
+    void connect(boost::asio::ip::tcp::socket& socket, const Endpoints& endpoints);
+
+    /**
+     * Resolve host (see \ref resolve) and connect socket to it.
+     *
+     * Cached entry is dropped if no endpoint answers, so next attempt
+     * resolves host again instead of retrying same addresses.
+     *
+     * \throws boost::system::system_error if resolution or all attempts failed.
+     */
+    void connect(boost::asio::ip::tcp::socket& socket, const std::string& host, unsigned short port);
+}} // namespace Hexicord::DNS
+
+#endif // HEXICORD_RESOLVER_HPP
@@ -1,9 +1,12 @@
 #include "hexicord/internal/rest.hpp"
 
-#include <cstdint>                                  // uint8_t
-#include <locale>                                   // std::tolower, std::locale
+#include <cstdint>                                  // uint8_t, uint64_t
+#include <algorithm>                                // std::min
+#include <array>                                    // std::array
+#include <stdexcept>                                // std::runtime_error
+#include <memory>                                   // std::unique_ptr
+#include <utility>                                  // std::move
 #include <boost/asio/ssl/rfc2818_verification.hpp>  // boost::asio::ssl::rfc2818_verification.hpp
-#include <boost/asio/connect.hpp>                   // boost::asio::connect
 #include <boost/asio/io_service.hpp>                // boost::asio::io_service
 #include <boost/asio/ip/tcp.hpp>                    // boost::asio::ip::tcp
 #include <boost/asio/ssl/error.hpp>                 // boost::asio::ssl::error
@@ -13,8 +16,21 @@
 #include <boost/beast/http/write.hpp>               // boost::beast::http::write
 #include <boost/beast/http/read.hpp>                // boost::beast::http::read
 #include <boost/beast/http/vector_body.hpp>         // boost::beast::http::vector_body
+#include <boost/beast/http/empty_body.hpp>          // boost::beast::http::empty_body
+#include <boost/beast/http/serializer.hpp>          // boost::beast::http::request_serializer
+#include <boost/asio/buffer.hpp>                    // boost::asio::const_buffer
+#include <boost/asio/write.hpp>                     // boost::asio::write
 #include <boost/beast/core/flat_buffer.hpp>         // boost::beast::flat_buffer
+#include "hexicord/internal/resolver.hpp"           // Hexicord::DNS
+#include "hexicord/internal/tls_context.hpp"        // Hexicord::TLS
 #include "hexicord/internal/utils.hpp"              // Hexicord::Utils::randomAsciiString
+#include "hexicord/config.hpp"                      // HEXICORD_REST_COMPRESSION, HEXICORD_ZLIB
+
+#if defined(HEXICORD_REST_COMPRESSION) && defined(HEXICORD_ZLIB)
+    #include <boost/beast/http/buffer_body.hpp>     // boost::beast::http::buffer_body
+    #include <boost/beast/http/parser.hpp>          // boost::beast::http::response_parser
+    #include "hexicord/internal/zlib.hpp"           // Hexicord::Zlib::Inflater
+#endif
 
 namespace ssl = boost::asio::ssl;
 using     tcp = boost::asio::ip::tcp;
@@ -22,46 +38,58 @@ using     tcp = boost::asio::ip::tcp;
 namespace Hexicord { namespace REST {
 struct HTTPSConnectionInternal {
     explicit HTTPSConnectionInternal(boost::asio::io_service& ios)
-        : tlsctx(boost::asio::ssl::context::tlsv12_client)
-        , stream(ios, tlsctx) {}
+        : stream(ios, TLS::clientContext()) {}
 
-    boost::asio::ssl::context tlsctx;
     boost::asio::ssl::stream<boost::asio::ip::tcp::socket> stream;
+
+    // Reused between requests to not reallocate it every time.
+    boost::beast::flat_buffer readBuffer;
 };
 
-namespace _Detail {
-    std::string stringToLower(const std::string& input) {
-        std::string result;
-        result.reserve(input.size());
+struct HTTPResponseInternal {
+    boost::beast::http::response<boost::beast::http::vector_body<uint8_t> > message;
+};
 
-        for (char ch : input) {
-            result.push_back(std::tolower(ch, std::locale("C")));
-        }
-        return result;
-    }
-} // namespace _Detail
+HTTPResponse::HTTPResponse()
+    : message(std::make_shared<HTTPResponseInternal>()) {}
+
+boost::string_view HTTPResponse::header(boost::string_view name) const {
+    auto it = message->message.find(name);
+    if (it == message->message.end()) return {};
+    return it->value();
+}
 
-HTTPSConnection::HTTPSConnection(boost::asio::io_service& ioService, const std::string& serverName) 
+std::vector<uint8_t>& HTTPResponse::body() {
+    return message->message.body;
+}
+
+const std::vector<uint8_t>& HTTPResponse::body() const {
+    return message->message.body;
+}
+
+HTTPSConnection::HTTPSConnection(boost::asio::io_service& ioService, const std::string& serverName,
+                                 unsigned short port, bool tls)
     : serverName(serverName)
+    , port(port)
+    , tls(tls)
     , connection(new HTTPSConnectionInternal(ioService)) {
 
-    connection->tlsctx.set_verify_mode(ssl::verify_peer | ssl::verify_fail_if_no_peer_cert);
-    connection->tlsctx.set_verify_callback(ssl::rfc2818_verification(serverName));
-    connection->tlsctx.set_default_verify_paths();
+    connection->stream.set_verify_callback(ssl::rfc2818_verification(serverName));
 }
 
 void HTTPSConnection::open() {
-    tcp::resolver resolver(connection->stream.get_io_service());
-
-    boost::asio::connect(connection->stream.next_layer(), resolver.resolve({ serverName, "443", tcp::resolver::query::numeric_service }));
+    DNS::connect(connection->stream.next_layer(), serverName, port);
     connection->stream.next_layer().set_option(tcp::no_delay(true));
-    connection->stream.handshake(ssl::stream_base::client);
+    if (tls) {
+        TLS::prepareSession(connection->stream.native_handle(), serverName);
+        connection->stream.handshake(ssl::stream_base::client);
+    }
     alive = true;
 }
 
 void HTTPSConnection::close() {
     boost::system::error_code ec;
-    connection->stream.shutdown(ec);
+    if (tls) connection->stream.shutdown(ec);
     if (ec && 
         ec != boost::asio::error::eof && 
         ec != boost::asio::ssl::error::stream_truncated &&
@@ -78,23 +106,175 @@ bool HTTPSConnection::isOpen() const {
     return connection->stream.lowest_layer().is_open() && alive;
 }
 
+BodySegment::BodySegment(std::vector<uint8_t> bytes) {
+    auto owned = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+    pointer = owned->data();
+    length  = owned->size();
+    storage = std::move(owned);
+}
+
+BodySegment::BodySegment(std::string bytes) {
+    auto owned = std::make_shared<const std::string>(std::move(bytes));
+    pointer = reinterpret_cast<const uint8_t*>(owned->data());
+    length  = owned->size();
+    storage = std::move(owned);
+}
+
+BodySegment::BodySegment(const uint8_t* data, size_t size, std::shared_ptr<const void> keepalive)
+    : storage(std::move(keepalive))
+    , pointer(data)
+    , length(size) {}
+
+BodySegment::BodySegment(uint64_t size, Reader reader)
+    : length(size)
+    , readFunction(std::move(reader)) {}
+
+namespace {
+    template<typename SyncWriteStream>
+    void writeBody(SyncWriteStream& stream, const std::vector<BodySegment>& body) {
+        // In-memory segments are collected and written by one call,
+        // segments with reader are streamed through fixed-size buffer.
+        std::vector<boost::asio::const_buffer> pending;
+        pending.reserve(body.size());
+
+        for (const BodySegment& segment : body) {
+            if (segment.size() == 0) continue;
+
+            if (segment.data()) {
+                pending.emplace_back(segment.data(), segment.size());
+                continue;
+            }
+
+            if (!pending.empty()) {
+                boost::asio::write(stream, pending);
+                pending.clear();
+            }
+
+            std::array<uint8_t, 64 * 1024> chunk;
+            for (uint64_t offset = 0; offset < segment.size();) {
+                size_t wanted = size_t(std::min<uint64_t>(chunk.size(), segment.size() - offset));
+                size_t read = segment.reader()(offset, chunk.data(), wanted);
+                if (read == 0) {
+                    throw std::runtime_error("Body segment reader returned less data than expected.");
+                }
+
+                boost::asio::write(stream, boost::asio::buffer(chunk.data(), read));
+                offset += read;
+            }
+        }
+
+        if (!pending.empty()) boost::asio::write(stream, pending);
+    }
+
+#if defined(HEXICORD_REST_COMPRESSION) && defined(HEXICORD_ZLIB)
+    // Reads body in chunks: compressed body is inflated as it arrives and
+    // never stored as whole, plain body is read right into message.
+    template<typename SyncReadStream>
+    void readResponse(SyncReadStream& stream, boost::beast::flat_buffer& buffer,
+                      boost::beast::http::response<boost::beast::http::vector_body<uint8_t> >& response) {
+
+        namespace http = boost::beast::http;
+
+        http::response_parser<http::buffer_body> parser;
+        http::read_header(stream, buffer, parser);
+
+        response.base() = std::move(parser.get().base());
+        std::vector<uint8_t>& body = response.body;
+
+        std::unique_ptr<Zlib::Inflater> inflater;
+        boost::string_view encoding = response[http::field::content_encoding];
+        if (encoding == "gzip" || encoding == "deflate") {
+            inflater.reset(new Zlib::Inflater());
+
+            // Headers should describe body we return.
+            response.erase(http::field::content_encoding);
+            response.erase(http::field::content_length);
+        } else if (parser.content_length()) {
+            body.reserve(size_t(*parser.content_length()));
+        }
+
+        std::array<uint8_t, 16 * 1024> chunk;
+        while (!parser.is_done()) {
+            size_t offset = body.size();
+            uint8_t* target = chunk.data();
+            if (!inflater) {
+                body.resize(offset + chunk.size());
+                target = body.data() + offset;
+            }
+            parser.get().body.data = target;
+            parser.get().body.size = chunk.size();
+
+            boost::system::error_code ec;
+            http::read(stream, buffer, parser, ec);
+            if (ec == http::error::need_buffer) ec = {};
+            if (ec) throw boost::system::system_error(ec);
+
+            size_t received = chunk.size() - parser.get().body.size;
+            if (inflater) {
+                inflater->feed(chunk.data(), received, body);
+            } else {
+                body.resize(offset + received);
+            }
+        }
+
+        // Otherwise truncated body would be returned as valid one.
+        if (inflater && !inflater->finished()) {
+            throw std::runtime_error("Compressed response body is truncated.");
+        }
+    }
+#else
+    template<typename SyncReadStream>
+    void readResponse(SyncReadStream& stream, boost::beast::flat_buffer& buffer,
+                      boost::beast::http::response<boost::beast::http::vector_body<uint8_t> >& response) {
+
+        boost::beast::http::read(stream, buffer, response);
+    }
+#endif
+
+    // Same for TLS stream and plain socket.
+    template<typename SyncStream>
+    void exchange(SyncStream& stream,
+                  boost::beast::http::request_serializer<boost::beast::http::empty_body>& serializer,
+                  const std::vector<BodySegment>& body,
+                  boost::beast::flat_buffer& buffer,
+                  boost::beast::http::response<boost::beast::http::vector_body<uint8_t> >& response,
+                  bool& written) {
+
+        boost::system::error_code ec;
+        boost::beast::http::write_header(stream, serializer, ec);
+        if (ec && ec != boost::beast::http::error::end_of_stream) throw boost::system::system_error(ec);
+        written = true;
+
+        writeBody(stream, body);
+
+        buffer.consume(buffer.size());
+        readResponse(stream, buffer, response);
+    }
+} // namespace
+
 HTTPResponse HTTPSConnection::request(const HTTPRequest& request) {
     //
     // Prepare request
     //
-    boost::beast::http::request<boost::beast::http::vector_body<uint8_t> > rawRequest;
-    
+    boost::beast::http::request<boost::beast::http::empty_body> rawRequest;
+
     rawRequest.method_string(request.method);
     rawRequest.target(request.path);
     rawRequest.version = request.version;
 
+    uint64_t contentLength = 0;
+    for (const BodySegment& segment : request.body) contentLength += segment.size();
+
     // Set default headers. 
     rawRequest.set("User-Agent", "Generic HTTP 1.1 Client");
     rawRequest.set("Connection", "keep-alive");
     rawRequest.set("Accept",     "*/*");
-    rawRequest.set("Host",       serverName);
-    if (!request.body.empty()) {
-        rawRequest.set("Content-Length", std::to_string(request.body.size()));
+#if defined(HEXICORD_REST_COMPRESSION) && defined(HEXICORD_ZLIB)
+    rawRequest.set("Accept-Encoding", "gzip, deflate");
+#endif
+    rawRequest.set("Host",       (port == (tls ? 443 : 80)) ? serverName : serverName + ":" + std::to_string(port));
+    if (contentLength != 0) {
+        rawRequest.set("Content-Length", std::to_string(contentLength));
         rawRequest.set("Content-Type",   "application/octet-stream");
     }
 
@@ -108,39 +288,32 @@ HTTPResponse HTTPSConnection::request(const HTTPRequest& request) {
         rawRequest.set(header.first, header.second);
     }
 
-    if (!request.body.empty()) {
-        rawRequest.body = request.body;
-    }
-
     //
     // Perform request.
     //
     
-    boost::system::error_code ec;
+    alive   = false;
+    written = false;
 
-    rawRequest.prepare_payload();
-    alive = false;
-    boost::beast::http::write(connection->stream, rawRequest, ec);
-    if (ec && ec != boost::beast::http::error::end_of_stream) throw boost::system::system_error(ec);
-
-    boost::beast::http::response<boost::beast::http::vector_body<uint8_t> > response;
-    boost::beast::flat_buffer buffer;
-    boost::beast::http::read(connection->stream, buffer, response);
-
-    REST::HTTPResponse responseStruct;
-    responseStruct.statusCode = response.result_int();
-    responseStruct.body      = response.body;
-    for (const auto& header : response) {
-        responseStruct.headers.insert({ header.name_string().to_string(), header.value().to_string() });
+    // Body is written by us directly to stream, so it's never copied
+    // into beast message. Message is parsed right into response object,
+    // headers and body are never copied after that.
+    boost::beast::http::request_serializer<boost::beast::http::empty_body> serializer(rawRequest);
+    REST::HTTPResponse response;
+    if (tls) {
+        exchange(connection->stream, serializer, request.body, connection->readBuffer, response.message->message, written);
+    } else {
+        exchange(connection->stream.next_layer(), serializer, request.body, connection->readBuffer, response.message->message, written);
     }
-    alive = (response["Connection"].to_string() != "close");
+
+    response.statusCode = response.message->message.result_int();
+    alive = (response.header("Connection") != "close");
     
-    return responseStruct;
+    return response;
 }
 
 HTTPRequest buildMultipartRequest(const std::vector<MultipartEntity>& elements) {
     HTTPRequest request;
-    std::ostringstream oss;
 
     // XXX: There is some reason for 400 Bad Request coming from Utils::randomAsciiString.
     // std::string boundary = Utils::randomAsciiString(64);
@@ -148,33 +321,41 @@ HTTPRequest buildMultipartRequest(const std::vector<MultipartEntity>& elements)
 
     request.headers["Content-Type"] = std::string("multipart/form-data; boundary=") + boundary;
 
-    for (auto it = elements.begin(); it != elements.end(); ++it) {
-        const auto& element = *it;
+    // Headers of each entity are concatenated with trailer of previous one,
+    // so body consists of (text, entity body) pairs and final text.
+    request.body.reserve(elements.size() * 2 + 1);
 
-        oss << "--" << boundary << "\r\n"
-            << "Content-Disposition: form-data; name=\"" << element.name << "\"";
+    std::string text;
+    for (const MultipartEntity& element : elements) {
+        text += "--";
+        text += boundary;
+        text += "\r\nContent-Disposition: form-data; name=\"";
+        text += element.name;
+        text += '"';
         if (!element.filename.empty()) {
-            oss << "; filename=\"" << element.filename << '"';
+            text += "; filename=\"";
+            text += element.filename;
+            text += '"';
         }
-        oss << "\r\n";
+        text += "\r\n";
         for (const auto& header : element.additionalHeaders) {
-            oss << header.first << ": " << header.second << "\r\n";
+            text += header.first;
+            text += ": ";
+            text += header.second;
+            text += "\r\n";
         }
-        oss << "\r\n";
-        for (uint8_t byte : element.body) {
-            oss << byte;
-        }
-        oss << "\r\n";
+        text += "\r\n";
 
-        oss << "--" << boundary;
-        if (it == elements.end() - 1) {
-            oss << "--";
-        }
-        oss << "\r\n";
+        request.body.emplace_back(std::move(text));
+        request.body.push_back(element.body);
+
+        text = "\r\n";
     }
+    text += "--";
+    text += boundary;
+    text += "--\r\n";
+    request.body.emplace_back(std::move(text));
 
-    std::string resultStr = oss.str();
-    request.body = std::vector<uint8_t>(resultStr.begin(), resultStr.end());
     return request;
 }
 
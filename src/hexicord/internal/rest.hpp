@@ -1,34 +1,124 @@
 #ifndef HEXICORD_REST_HPP
 #define HEXICORD_REST_HPP
 
-#include <cstdint>        // uint8_t
+#include <cstdint>        // uint8_t, uint64_t
+#include <cstddef>        // size_t
+#include <functional>     // std::function
 #include <string>         // std::string
 #include <vector>         // std::vector
 #include <unordered_map>  // std::unordered_map
 #include <memory>         // std::shared_ptr
+#include <boost/utility/string_view.hpp> // boost::string_view
 namespace boost { namespace asio { class io_service; }}
 
 namespace Hexicord { namespace REST {
     struct HTTPSConnectionInternal;
 
+    struct HTTPResponseInternal;
+
     namespace _Detail {
-        std::string stringToLower(const std::string& input);
+        inline char asciiToLower(char ch) {
+            return (ch >= 'A' && ch <= 'Z') ? char(ch - 'A' + 'a') : ch;
+        }
+
+        /// FNV-1a hash of ASCII-lowercased string, doesn't allocate.
+        struct CaseInsensibleStringHash {
+            inline size_t operator()(const std::string& str) const {
+                uint64_t hash = 14695981039346656037ULL;
+                for (char ch : str) {
+                    hash ^= uint8_t(asciiToLower(ch));
+                    hash *= 1099511628211ULL;
+                }
+                return size_t(hash);
+            }
+        };
 
         struct CaseInsensibleStringEqual {
             inline bool operator()(const std::string& lhs, const std::string& rhs) const {
-                return stringToLower(lhs) == stringToLower(rhs);
+                if (lhs.size() != rhs.size()) return false;
+                for (size_t i = 0; i < lhs.size(); ++i) {
+                    if (asciiToLower(lhs[i]) != asciiToLower(rhs[i])) return false;
+                }
+                return true;
             }
         };
     } // namespace _Detail
 
     /// Hash-map with case-insensible string keys.
-    using HeadersMap = std::unordered_map<std::string, std::string, std::hash<std::string>, _Detail::CaseInsensibleStringEqual>;
+    using HeadersMap = std::unordered_map<std::string, std::string, _Detail::CaseInsensibleStringHash, _Detail::CaseInsensibleStringEqual>;
+
+    /**
+     * Received response. Headers and body are stored in parsed message
+     * as is, nothing is copied.
+     *
+     * Copies share same message.
+     */
+    class HTTPResponse {
+    public:
+        HTTPResponse();
 
-    struct HTTPResponse {
-        unsigned statusCode;
+        unsigned statusCode = 0;
 
-        HeadersMap headers;
-        std::vector<uint8_t> body;
+        /**
+         * Value of header (case-insensible), empty if there is no such
+         * header. Valid while response exists.
+         */
+        boost::string_view header(boost::string_view name) const;
+
+        std::vector<uint8_t>& body();
+        const std::vector<uint8_t>& body() const;
+
+    private:
+        friend class HTTPSConnection;
+
+        std::shared_ptr<HTTPResponseInternal> message;
+    };
+
+    /**
+     * Part of request body. Body is sent as sequence of such segments
+     * without concatenating them first.
+     *
+     * Segment either points to memory (owned by segment or by someone
+     * else) or reads data on demand using Reader function.
+     *
+     * Copying segment never copies data.
+     */
+    class BodySegment {
+    public:
+        /**
+         * Should read at most size bytes starting at offset into buffer and
+         * return count of bytes read. Returning 0 before reaching segment
+         * size is an error.
+         */
+        using Reader = std::function<size_t(uint64_t offset, uint8_t* buffer, size_t size)>;
+
+        BodySegment() = default;
+
+        /// Take ownership of bytes.
+        BodySegment(std::vector<uint8_t> bytes);
+
+        /// Take ownership of bytes.
+        BodySegment(std::string bytes);
+
+        /// Refer to memory owned by someone else. If keepalive is passed,
+        /// segment shares ownership of it, otherwise memory should not be
+        /// freed while segment (or copy of it) is used.
+        BodySegment(const uint8_t* data, size_t size, std::shared_ptr<const void> keepalive = nullptr);
+
+        /// Read data using reader when sent.
+        BodySegment(uint64_t size, Reader reader);
+
+        inline uint64_t size() const { return length; }
+
+        /// Pointer to segment data or nullptr if segment uses reader.
+        inline const uint8_t* data() const { return pointer; }
+
+        inline const Reader& reader() const { return readFunction; }
+    private:
+        std::shared_ptr<const void> storage;
+        const uint8_t* pointer = nullptr;
+        uint64_t length = 0;
+        Reader readFunction;
     };
 
     struct HTTPRequest {
@@ -36,13 +126,18 @@ namespace Hexicord { namespace REST {
         std::string path;
 
         unsigned version;
-        std::vector<uint8_t> body;
+        std::vector<BodySegment> body;
         HeadersMap headers;
     };
 
     class HTTPSConnection {
     public:
-        HTTPSConnection(boost::asio::io_service& ioService, const std::string& serverName);
+        /**
+         * \param tls Use plain HTTP if false, intended for local testing
+         *            servers only.
+         */
+        HTTPSConnection(boost::asio::io_service& ioService, const std::string& serverName,
+                        unsigned short port = 443, bool tls = true);
 
         void open();
         void close();
@@ -51,13 +146,22 @@ namespace Hexicord { namespace REST {
 
         HTTPResponse request(const HTTPRequest& request);
 
+        /**
+         * True if headers of last request were written, i.e. server may
+         * have processed it even if request() failed later.
+         */
+        bool requestWritten() const { return written; }
+
         HeadersMap connectionHeaders;
         const std::string serverName;
+        const unsigned short port;
+        const bool tls;
 
     private:
         std::shared_ptr<HTTPSConnectionInternal> connection;
 
         bool alive = false;
+        bool written = false;
     };
 
     struct MultipartEntity {
@@ -65,9 +169,13 @@ namespace Hexicord { namespace REST {
         std::string filename;
         HeadersMap additionalHeaders;
 
-        std::vector<uint8_t> body;
+        BodySegment body;
     };
 
+    /**
+     * Build multipart/form-data request. Entities bodies are not copied,
+     * returned request refers to same data.
+     */
     HTTPRequest buildMultipartRequest(const std::vector<MultipartEntity>& elements);
 
 }} // namespace Hexicord::REST
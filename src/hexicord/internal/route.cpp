@@ -0,0 +1,89 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/internal/route.hpp"
+#include <cstring>      // std::memcpy, std::strchr
+#include <stdexcept>    // std::length_error
+
+namespace Hexicord {
+    namespace {
+        bool isMajorParameter(boost::string_view name) {
+            return name == "channel" || name == "guild" || name == "webhook";
+        }
+
+        void append(char* buffer, size_t& length, boost::string_view str) {
+            if (length + str.size() > Route::BufferSize) {
+                throw std::length_error("Formatted route is too long.");
+            }
+            std::memcpy(buffer + length, str.data(), str.size());
+            length += str.size();
+        }
+    } // namespace
+
+    Route::Argument::Argument(Snowflake id) {
+        // Write digits from the end, then move them to the beginning.
+        char reversed[20];
+        uint64_t value = id;
+        do {
+            reversed[length++] = char('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+
+        for (size_t i = 0; i < length; ++i) {
+            digits[i] = reversed[length - i - 1];
+        }
+    }
+
+    constexpr size_t Route::BufferSize;
+
+    Route::Route(const char* pattern, const Argument* arguments)
+        : routePattern(pattern) {
+
+        const char* current = pattern;
+        while (*current != '\0') {
+            const char* placeholder = std::strchr(current, '{');
+            if (!placeholder) {
+                boost::string_view rest(current);
+                append(pathBuffer, pathLength, rest);
+                append(bucketBuffer, bucketLength, rest);
+                break;
+            }
+
+            boost::string_view literal(current, size_t(placeholder - current));
+            append(pathBuffer, pathLength, literal);
+            append(bucketBuffer, bucketLength, literal);
+
+            const char* placeholderEnd = std::strchr(placeholder, '}');
+            boost::string_view name(placeholder + 1, size_t(placeholderEnd - placeholder - 1));
+            boost::string_view value = (arguments++)->view();
+
+            append(pathBuffer, pathLength, value);
+            if (isMajorParameter(name)) {
+                append(bucketBuffer, bucketLength, value);
+            } else {
+                append(bucketBuffer, bucketLength, boost::string_view(placeholder, name.size() + 2));
+            }
+
+            current = placeholderEnd + 1;
+        }
+    }
+} // namespace Hexicord
@@ -0,0 +1,161 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_ROUTE_HPP
+#define HEXICORD_ROUTE_HPP
+
+#include <cstddef>                          // size_t
+#include <string>                           // std::string
+#include <boost/utility/string_view.hpp>    // boost::string_view
+#include "hexicord/types.hpp"               // Hexicord::Snowflake
+
+/**
+ * REST endpoints as compile-time patterns.
+ *
+ * Placeholders are written in braces. {channel}, {guild} and {webhook} are
+ * major parameters: they are part of ratelimit bucket key, all other
+ * placeholders are not.
+ */
+
+namespace Hexicord {
+    namespace Routes {
+        constexpr char Gateway[]                = "/gateway";
+        constexpr char GatewayBot[]             = "/gateway/bot";
+
+        constexpr char Channel[]                = "/channels/{channel}";
+        constexpr char ChannelMessages[]        = "/channels/{channel}/messages";
+        constexpr char ChannelMessage[]         = "/channels/{channel}/messages/{message}";
+        constexpr char ChannelBulkDelete[]      = "/channels/{channel}/messages/bulk-delete";
+        constexpr char ChannelPins[]            = "/channels/{channel}/pins";
+        constexpr char ChannelPin[]             = "/channels/{channel}/pins/{message}";
+        constexpr char ChannelPermission[]      = "/channels/{channel}/permissions/{overwrite}";
+        constexpr char ChannelRecipient[]       = "/channels/{channel}/recipients/{user}";
+        constexpr char ChannelTyping[]          = "/channels/{channel}/typing";
+        constexpr char ChannelInvites[]         = "/channels/{channel}/invites";
+        constexpr char ChannelWebhooks[]        = "/channels/{channel}/webhooks";
+        constexpr char MessageReactions[]       = "/channels/{channel}/messages/{message}/reactions";
+        constexpr char MessageReaction[]        = "/channels/{channel}/messages/{message}/reactions/{emoji}";
+        constexpr char MessageOwnReaction[]     = "/channels/{channel}/messages/{message}/reactions/{emoji}/@me";
+        constexpr char MessageUserReaction[]    = "/channels/{channel}/messages/{message}/reactions/{emoji}/{user}";
+
+        constexpr char Guilds[]                 = "/guilds";
+        constexpr char Guild[]                  = "/guilds/{guild}";
+        constexpr char GuildBans[]              = "/guilds/{guild}/bans";
+        constexpr char GuildBan[]               = "/guilds/{guild}/bans/{user}";
+        constexpr char GuildChannels[]          = "/guilds/{guild}/channels";
+        constexpr char GuildMembers[]           = "/guilds/{guild}/members";
+        constexpr char GuildMember[]            = "/guilds/{guild}/members/{user}";
+        constexpr char GuildMemberRole[]        = "/guilds/{guild}/members/{user}/roles/{role}";
+        constexpr char GuildIntegrations[]      = "/guilds/{guild}/integrations";
+        constexpr char GuildIntegration[]       = "/guilds/{guild}/integrations/{integration}";
+        constexpr char GuildIntegrationSync[]   = "/guilds/{guild}/integrations/{integration}/sync";
+        constexpr char GuildEmbed[]             = "/guilds/{guild}/embed";
+        constexpr char GuildRoles[]             = "/guilds/{guild}/roles";
+        constexpr char GuildRole[]              = "/guilds/{guild}/roles/{role}";
+        constexpr char GuildPrune[]             = "/guilds/{guild}/prune";
+        constexpr char GuildInvites[]           = "/guilds/{guild}/invites";
+        constexpr char GuildWebhooks[]          = "/guilds/{guild}/webhooks";
+
+        constexpr char Me[]                     = "/users/@me";
+        constexpr char User[]                   = "/users/{user}";
+        constexpr char MyGuilds[]               = "/users/@me/guilds";
+        constexpr char MyGuild[]                = "/users/@me/guilds/{guild}";
+        constexpr char MyChannels[]             = "/users/@me/channels";
+        constexpr char MyConnections[]          = "/users/@me/connections";
+
+        constexpr char Invite[]                 = "/invites/{code}";
+
+        constexpr char Webhook[]                = "/webhooks/{webhook}";
+        constexpr char WebhookWithToken[]       = "/webhooks/{webhook}/{token}";
+    } // namespace Routes
+
+    namespace _Detail {
+        constexpr unsigned countPlaceholders(const char* pattern) {
+            return *pattern == '\0' ? 0 : unsigned(*pattern == '{') + countPlaceholders(pattern + 1);
+        }
+    } // namespace _Detail
+
+    /**
+     * Endpoint path formatted from pattern, together with its ratelimit
+     * bucket key. Both are stored inline, nothing is allocated.
+     *
+     * ```cpp
+     * Route route = Route::make<Routes::ChannelMessage>(channelId, messageId);
+     * route.path();   // "/channels/1234/messages/5678"
+     * route.bucket(); // "/channels/1234/messages/{message}"
+     * ```
+     */
+    class Route {
+    public:
+        /// Placeholder value: snowflake or string (invite code, etc).
+        class Argument {
+        public:
+            Argument() = default;
+            Argument(Snowflake id);
+            Argument(const std::string& str) : external(str.data()), length(str.size()) {}
+
+            inline boost::string_view view() const {
+                return { external ? external : digits, length };
+            }
+        private:
+            char digits[20];
+            const char* external = nullptr;
+            size_t length = 0;
+        };
+
+        /**
+         * Format Pattern (one of \ref Routes constants) with arguments
+         * substituted in order of placeholders.
+         *
+         * \throws std::length_error if formatted path doesn't fits in
+         *         internal buffer.
+         */
+        template<const char* Pattern, typename... Args>
+        static Route make(const Args&... args) {
+            static_assert(_Detail::countPlaceholders(Pattern) == sizeof...(Args),
+                          "Arguments count doesn't matches placeholders count in route pattern.");
+
+            const Argument arguments[sizeof...(Args) + 1] = { Argument(args)... };
+            return Route(Pattern, arguments);
+        }
+
+        inline boost::string_view path() const { return { pathBuffer, pathLength }; }
+        inline boost::string_view bucket() const { return { bucketBuffer, bucketLength }; }
+        inline const char* pattern() const { return routePattern; }
+
+        /// Maximum length of formatted path.
+        static constexpr size_t BufferSize = 512;
+
+    private:
+        Route(const char* pattern, const Argument* arguments);
+
+        const char* routePattern;
+
+        char pathBuffer[BufferSize];
+        size_t pathLength = 0;
+
+        char bucketBuffer[BufferSize];
+        size_t bucketLength = 0;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_ROUTE_HPP
@@ -0,0 +1,112 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/internal/tls_context.hpp"
+
+#include <mutex>                        // std::mutex, std::lock_guard
+#include <unordered_map>                // std::unordered_map
+#include <openssl/ssl.h>                // SSL_*, SSL_CTX_*
+#include "hexicord/config.hpp"          // HEXICORD_DEBUG_LOG
+
+#ifdef HEXICORD_DEBUG_LOG
+    #include <iostream>
+    #define DEBUG_MSG(msg) do { std::cerr << "tls_context.cpp:" << __LINE__ << "\t" << (msg) << '\n'; } while (false)
+#else
+    #define DEBUG_MSG(msg)
+#endif
+
+namespace Hexicord { namespace TLS {
+    namespace {
+        class SessionCache {
+        public:
+            // Takes ownership of session.
+            void put(const std::string& serverName, SSL_SESSION* session) {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                auto it = sessions.find(serverName);
+                if (it != sessions.end()) {
+                    SSL_SESSION_free(it->second);
+                    it->second = session;
+                } else {
+                    sessions.emplace(serverName, session);
+                }
+            }
+
+            // Returns false if there is no session for serverName.
+            bool resume(SSL* handle, const std::string& serverName) {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                auto it = sessions.find(serverName);
+                if (it == sessions.end()) return false;
+
+                // SSL_set_session takes its own reference.
+                return SSL_set_session(handle, it->second) == 1;
+            }
+
+        private:
+            std::mutex mutex;
+            std::unordered_map<std::string, SSL_SESSION*> sessions;
+        };
+
+        SessionCache& sessionCache() {
+            // Not destroyed for same reason as context.
+            static SessionCache* cache = new SessionCache;
+            return *cache;
+        }
+
+        int onNewSession(SSL* handle, SSL_SESSION* session) {
+            const char* serverName = SSL_get_servername(handle, TLSEXT_NAMETYPE_host_name);
+            if (!serverName) return 0; // We don't own session, OpenSSL frees it.
+
+            DEBUG_MSG(std::string("Got TLS session for ") + serverName);
+            sessionCache().put(serverName, session);
+            return 1;
+        }
+    } // namespace
+
+    boost::asio::ssl::context& clientContext() {
+        // Function-local static is initialized once, even if called from
+        // multiple threads. Context is never destroyed, so connections
+        // living in other static objects can use it until exit.
+        static boost::asio::ssl::context* context = []() {
+            auto result = new boost::asio::ssl::context(boost::asio::ssl::context::tlsv12_client);
+            result->set_default_verify_paths();
+            result->set_verify_mode(boost::asio::ssl::verify_peer | boost::asio::ssl::verify_fail_if_no_peer_cert);
+
+            // Sessions are stored in our cache keyed by server name, internal
+            // cache is useless for client (it's keyed by session id).
+            SSL_CTX_set_session_cache_mode(result->native_handle(),
+                                           SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb(result->native_handle(), onNewSession);
+            return result;
+        }();
+        return *context;
+    }
+
+    void prepareSession(SSL* handle, const std::string& serverName) {
+        SSL_set_tlsext_host_name(handle, serverName.c_str());
+
+        if (sessionCache().resume(handle, serverName)) {
+            DEBUG_MSG(std::string("Resuming TLS session for ") + serverName);
+        }
+    }
+}} // namespace Hexicord::TLS
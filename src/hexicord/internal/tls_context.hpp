@@ -0,0 +1,48 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_TLS_CONTEXT_HPP
+#define HEXICORD_TLS_CONTEXT_HPP
+
+#include <string>                       // std::string
+#include <boost/asio/ssl/context.hpp>   // boost::asio::ssl::context
+
+typedef struct ssl_st SSL;
+
+namespace Hexicord { namespace TLS {
+    /**
+     * Process-wide TLS client context shared by all connections.
+     *
+     * CA certificates are loaded once, on first call. Sessions received
+     * from servers are remembered per server name, so reconnects
+     * perform abbreviated handshake.
+     */
+    boost::asio::ssl::context& clientContext();
+
+    /**
+     * Set SNI and resume last session for serverName if there is one.
+     * Should be called before handshake.
+     */
+    void prepareSession(SSL* handle, const std::string& serverName);
+}} // namespace Hexicord::TLS
+
+#endif // HEXICORD_TLS_CONTEXT_HPP
@@ -24,7 +24,6 @@
 #include <cctype>       // std::isalnum
 #include <ctime>        // std::time
 #include <cstdlib>      // std::rand, std::srand, size_t
-#include <cassert>      // assert
 #include <stdexcept>    // std::invalid_argument
 #include <sstream>      // std::ostringstream
 #include <iomanip>      // std::setw
@@ -33,57 +32,57 @@
 
 namespace Hexicord { namespace Utils {
     namespace Magic {
-        bool isGif(const std::vector<uint8_t>& bytes) {
+        bool isGif(const uint8_t* data, size_t size) {
             // according to http://fileformats.archiveteam.org/wiki/GIF
-            return bytes.size() >= 6 &&  // TODO: check against minimal headers size
-                bytes[0] == 'G' &&  // should begin with 'GIF'
-                bytes[1] == 'I' &&
-                bytes[2] == 'F' &&
+            return size >= 6 &&  // TODO: check against minimal headers size
+                data[0] == 'G' &&  // should begin with 'GIF'
+                data[1] == 'I' &&
+                data[2] == 'F' &&
                 ( // then GIF version, '87a' or '89a'
                     (
-                        bytes[3] == '8' &&
-                        bytes[4] == '7' &&
-                        bytes[5] == 'a'
+                        data[3] == '8' &&
+                        data[4] == '7' &&
+                        data[5] == 'a'
                     ) || (
-                        bytes[3] == '8' &&
-                        bytes[4] == '9' &&
-                        bytes[5] == 'a'
+                        data[3] == '8' &&
+                        data[4] == '9' &&
+                        data[5] == 'a'
                     )
                 ); 
         }
 
-        bool isJfif(const std::vector<uint8_t>& bytes) {
+        bool isJfif(const uint8_t* data, size_t size) {
             // according to http://fileformats.archiveteam.org/wiki/JFIF
-            return bytes.size() >= 3 && // TODO: check against minimal headers size
-                bytes[0] == 0xFF &&
-                bytes[1] == 0xD8 &&
-                bytes[2] == 0xFF;
+            return size >= 3 && // TODO: check against minimal headers size
+                data[0] == 0xFF &&
+                data[1] == 0xD8 &&
+                data[2] == 0xFF;
         }
 
-        bool isPng(const std::vector<uint8_t>& bytes) {
+        bool isPng(const uint8_t* data, size_t size) {
             // according to https://www.w3.org/TR/PNG/#5PNG-file-signature
-            return bytes.size() >= 12 && // signature + single no-data chunk size
-                bytes[0] == 137 &&
-                bytes[1] == 'P' &&
-                bytes[2] == 'N' &&
-                bytes[3] == 'G' &&
-                bytes[4] == 13  && // CR
-                bytes[5] == 10  && // LF
-                bytes[6] == 26  && // SUB
-                bytes[7] == 10;    // LF
+            return size >= 12 && // signature + single no-data chunk size
+                data[0] == 137 &&
+                data[1] == 'P' &&
+                data[2] == 'N' &&
+                data[3] == 'G' &&
+                data[4] == 13  && // CR
+                data[5] == 10  && // LF
+                data[6] == 26  && // SUB
+                data[7] == 10;    // LF
         }
 
-        bool isWebp(const std::vector<uint8_t>& bytes) {
+        bool isWebp(const uint8_t* data, size_t size) {
             // according to https://developers.google.com/speed/webp/docs/riff_container?csw=1
-            return bytes.size() >= 12 && // 'RIFF' + size + 'WEBP'
-                bytes[0]  == 'R' &&
-                bytes[1]  == 'I' &&
-                bytes[2]  == 'F' &&
-                bytes[3]  == 'F' &&
-                bytes[8]  == 'W' &&
-                bytes[9]  == 'E' &&
-                bytes[10] == 'B' &&
-                bytes[11] == 'P';
+            return size >= 12 && // 'RIFF' + size + 'WEBP'
+                data[0]  == 'R' &&
+                data[1]  == 'I' &&
+                data[2]  == 'F' &&
+                data[3]  == 'F' &&
+                data[8]  == 'W' &&
+                data[9]  == 'E' &&
+                data[10] == 'B' &&
+                data[11] == 'P';
         }
     } // namespace Magic
 
@@ -143,34 +142,6 @@ namespace Hexicord { namespace Utils {
 	   return result;
 	}
 
-	std::string base64Encode(const std::vector<uint8_t>& bytes)
-	{
-	   static constexpr uint8_t Base64Map[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-	   // Use = signs so the end is properly padded.
-	   std::string result((((bytes.size() + 2) / 3) * 4), '=');
-	   size_t outpos = 0;
-	   int bitsCollected = 0;
-	   unsigned accumulator = 0;
-
-	   for (uint8_t byte : bytes) {
-	      accumulator = (accumulator << 8) | (byte & 0xffu);
-	      bitsCollected += 8;
-	      while (bitsCollected >= 6) {
-	         bitsCollected -= 6;
-	         result[outpos++] = Base64Map[(accumulator >> bitsCollected) & 0x3fu];
-	      }
-	   }
-	   if (bitsCollected > 0) { // Any trailing bits that are missing.
-	      assert(bitsCollected < 6);
-	      accumulator <<= 6 - bitsCollected;
-	      result[outpos++] = Base64Map[accumulator & 0x3fu];
-	   }
-	   assert(outpos >= (result.size() - 2));
-	   assert(outpos <= result.size());
-	   return result;
-	}
-
     std::string urlEncode(const std::string& raw) {
         std::ostringstream resultStream;
 
@@ -23,6 +23,7 @@
 #define HEXICORD_UTILS_HPP
 
 #include <cstdint>        // uint8_t
+#include <cstddef>        // size_t
 #include <vector>         // std::vector
 #include <string>         // std::string
 #include <unordered_map>  // std::unordered_map
@@ -36,10 +37,10 @@ namespace Hexicord { namespace Utils {
      *  Fast but in-percise type identification based on first ("magic") bytes.
      */
     namespace Magic {
-        bool isGif(const std::vector<uint8_t>& bytes);
-        bool isJfif(const std::vector<uint8_t>& bytes);
-        bool isPng(const std::vector<uint8_t>& bytes);
-        bool isWebp(const std::vector<uint8_t>& bytes);
+        bool isGif(const uint8_t* data, size_t size);
+        bool isJfif(const uint8_t* data, size_t size);
+        bool isPng(const uint8_t* data, size_t size);
+        bool isWebp(const uint8_t* data, size_t size);
     }
 
     /**
@@ -47,10 +48,24 @@ namespace Hexicord { namespace Utils {
      */
     std::string domainFromUrl(const std::string& url);
 
+    /**
+     *  Length of base64 encoded data (with padding) for size input bytes.
+     */
+    constexpr size_t base64EncodedSize(size_t size) {
+        return (size + 2) / 3 * 4;
+    }
+
+    /**
+     *  Encode arbitrary data using base64 into output, which should have
+     *  space for base64EncodedSize(size) characters. Uses SSSE3 or AVX2
+     *  if supported by CPU.
+     */
+    void base64Encode(const uint8_t* data, size_t size, char* output);
+
     /**
      *  Encode arbitrary data using base64.
      */
-    std::string base64Encode(const std::vector<uint8_t>& bytes);
+    std::string base64Encode(const uint8_t* data, size_t size);
 
     std::string urlEncode(const std::string& raw);
     std::string makeQueryString(const std::unordered_map<std::string, std::string>& queryVariables);
@@ -0,0 +1,89 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/internal/worker_pool.hpp"
+
+#include <cassert>                      // assert
+#include <exception>                    // std::exception
+#include <string>                       // std::string
+#include <utility>                      // std::move
+#include "hexicord/config.hpp"          // HEXICORD_DEBUG_LOG
+
+#ifdef HEXICORD_DEBUG_LOG
+    #include <iostream>
+    #define DEBUG_MSG(msg) do { std::cerr << "worker_pool.cpp:" << __LINE__ << "\t" << (msg) << '\n'; } while (false)
+#else
+    #define DEBUG_MSG(msg)
+#endif
+
+namespace Hexicord {
+    WorkerPool::WorkerPool(unsigned threadsCount) {
+        assert(threadsCount != 0);
+
+        threads.reserve(threadsCount);
+        for (unsigned i = 0; i < threadsCount; ++i) {
+            threads.emplace_back(&WorkerPool::run, this);
+        }
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        taskPosted.notify_all();
+
+        for (std::thread& thread : threads) thread.join();
+    }
+
+    void WorkerPool::post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        taskPosted.notify_one();
+    }
+
+    void WorkerPool::run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                taskPosted.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+                // Queue is drained before exit.
+                if (tasks.empty()) return;
+
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+
+            try {
+                task();
+            } catch (std::exception& excp) {
+                DEBUG_MSG(std::string("Exception escaped from worker task: ") + excp.what());
+            } catch (...) {
+                DEBUG_MSG("Unknown exception escaped from worker task.");
+            }
+        }
+    }
+} // namespace Hexicord
@@ -0,0 +1,67 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_WORKER_POOL_HPP
+#define HEXICORD_WORKER_POOL_HPP
+
+#include <condition_variable>   // std::condition_variable
+#include <deque>                // std::deque
+#include <functional>           // std::function
+#include <mutex>                // std::mutex
+#include <thread>               // std::thread
+#include <vector>               // std::vector
+
+namespace Hexicord {
+    /**
+     * Fixed set of threads executing posted tasks in FIFO order.
+     */
+    class WorkerPool {
+    public:
+        explicit WorkerPool(unsigned threadsCount);
+
+        /**
+         * Finishes all posted tasks and joins threads.
+         */
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /**
+         * Queue task for execution. Exceptions thrown by task are ignored,
+         * so task should report them itself (for example, through promise).
+         */
+        void post(std::function<void()> task);
+
+    private:
+        void run();
+
+        std::mutex mutex;
+        std::condition_variable taskPosted;
+        std::deque<std::function<void()>> tasks;
+        bool stopping = false;
+
+        std::vector<std::thread> threads;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_WORKER_POOL_HPP
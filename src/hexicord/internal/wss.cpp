@@ -21,12 +21,14 @@
 
 #include "hexicord/internal/wss.hpp"
 #include <boost/beast/core/flat_buffer.hpp>
-#include <boost/asio/connect.hpp>
 #include <boost/asio/ssl/context.hpp>         // boost::asio::ssl::context
 #include <boost/asio/ssl/stream.hpp>          // boost::asio::ssl::stream
 #include <boost/beast/websocket/stream.hpp>   // websocket::stream
 #include <boost/beast/websocket/ssl.hpp>
 #include <boost/asio/ip/tcp.hpp>              // tcp::socket
+#include <boost/asio/ssl/rfc2818_verification.hpp> // boost::asio::ssl::rfc2818_verification
+#include "hexicord/internal/resolver.hpp"     // Hexicord::DNS
+#include "hexicord/internal/tls_context.hpp"  // Hexicord::TLS
 
 namespace websocket = boost::beast::websocket;
 using tlsstream     = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
@@ -38,19 +40,17 @@ namespace ssl = boost::asio::ssl;
 namespace Hexicord {
     struct WSSTLSConnection {
         explicit WSSTLSConnection(boost::asio::io_service& ios)
-            : tlsContext(boost::asio::ssl::context::tlsv12_client)
-            , wsStream(ios, tlsContext) {}
+            : wsStream(ios, TLS::clientContext()) {}
 
-        boost::asio::ssl::context tlsContext;
         wssstream wsStream;
     };
 
     TLSWebSocket::TLSWebSocket(boost::asio::io_service& ioService)
-        : connection(new WSSTLSConnection(ioService)) {
+        : connection(new WSSTLSConnection(ioService)) {}
 
-        connection->tlsContext.set_default_verify_paths();
-        connection->tlsContext.set_verify_mode(ssl::verify_peer | ssl::verify_fail_if_no_peer_cert);
-    }
+    TLSWebSocket::TLSWebSocket(boost::asio::io_service::strand& strand)
+        : connection(new WSSTLSConnection(strand.get_io_service()))
+        , strand(&strand) {}
 
     TLSWebSocket::~TLSWebSocket() {
         try {
@@ -63,8 +63,12 @@ namespace Hexicord {
     }
     
     void TLSWebSocket::sendMessage(const std::vector<uint8_t>& message) {
+        sendMessage(message.data(), message.size());
+    }
+
+    void TLSWebSocket::sendMessage(const uint8_t* data, size_t size) {
         std::lock_guard<std::mutex> lock(connectionMutex);
-        connection->wsStream.write(boost::asio::buffer(message.data(), message.size()));
+        connection->wsStream.write(boost::asio::buffer(data, size));
     }
     
     std::vector<uint8_t> TLSWebSocket::readMessage() {
@@ -82,7 +86,7 @@ namespace Hexicord {
     void TLSWebSocket::asyncReadMessage(const TLSWebSocket::AsyncReadCallback& callback) {
         std::shared_ptr<boost::beast::flat_buffer> buffer(new boost::beast::flat_buffer);
 
-        connection->wsStream.async_read(*buffer, [this, buffer, callback](boost::system::error_code ec, unsigned long length) {
+        auto handler = [this, buffer, callback](boost::system::error_code ec, unsigned long length) {
             // buffer captured by value into lambda.
             // so they will exist here and hold ownership.
 
@@ -93,21 +97,38 @@ namespace Hexicord {
 
             // however, buffer ownership will be released here and it will
             // removed. 
-        });
+        };
+
+        // Wrapped handler makes beast run intermediate handlers through strand too.
+        if (strand) {
+            connection->wsStream.async_read(*buffer, strand->wrap(handler));
+        } else {
+            connection->wsStream.async_read(*buffer, handler);
+        }
     }
 
     void TLSWebSocket::asyncSendMessage(const std::vector<uint8_t>& message, const TLSWebSocket::AsyncSendCallback& callback) {
-        connection->wsStream.async_write(boost::asio::buffer(message.data(), message.size()), [this, callback] (boost::system::error_code ec) {
+        asyncSendMessage(message.data(), message.size(), callback);
+    }
+
+    void TLSWebSocket::asyncSendMessage(const uint8_t* data, size_t size, const TLSWebSocket::AsyncSendCallback& callback) {
+        auto handler = [this, callback] (boost::system::error_code ec) {
             callback(*this, ec);
-        });
+        };
+
+        if (strand) {
+            connection->wsStream.async_write(boost::asio::buffer(data, size), strand->wrap(handler));
+        } else {
+            connection->wsStream.async_write(boost::asio::buffer(data, size), handler);
+        }
     }
 
     void TLSWebSocket::handshake(const std::string& servername, const std::string& path, unsigned short port, const std::unordered_map<std::string, std::string>& additionalHeaders) {
         std::lock_guard<std::mutex> lock(connectionMutex);
 
-        tcp::resolver resolver(connection->wsStream.get_io_service());
-
-        boost::asio::connect(connection->wsStream.lowest_layer(), resolver.resolve({ servername, std::to_string(port) }));
+        DNS::connect(connection->wsStream.next_layer().next_layer(), servername, port);
+        connection->wsStream.next_layer().set_verify_callback(ssl::rfc2818_verification(servername));
+        TLS::prepareSession(connection->wsStream.next_layer().native_handle(), servername);
         connection->wsStream.next_layer().handshake(ssl::stream_base::client);
         connection->wsStream.handshake_ex(servername, path, [&additionalHeaders](websocket::request_type& request) {
             for (const auto& header : additionalHeaders) {
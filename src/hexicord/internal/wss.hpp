@@ -22,13 +22,17 @@
 #ifndef HEXICORD_WSS_HPP
 #define HEXICORD_WSS_HPP
 
+#include <cstddef>       // size_t
+#include <cstdint>       // uint8_t
 #include <string>        // std::string
 #include <vector>        // std::vector
 #include <memory>        // std::enable_shared_from_this, std::shared_ptr
 #include <mutex>         // std::mutex
 #include <functional>    // std::function
 #include <unordered_map> // std::unordered_map
-namespace boost { namespace asio { class io_service; } namespace system { class error_code; }}
+#include <boost/asio/io_service.hpp> // boost::asio::io_service
+#include <boost/asio/strand.hpp>     // boost::asio::io_service::strand
+namespace boost { namespace system { class error_code; }}
 namespace Hexicord { class WSSTLSConnection; }
 
 /**
@@ -53,6 +57,14 @@ namespace Hexicord {
          */
         TLSWebSocket(boost::asio::io_service& ioService);
 
+        /**
+         *  Construct unconnected WebSocket which runs completion handlers
+         *  of async operations (including intermediate ones) through
+         *  \p strand. Required if io_service is run by more than one
+         *  thread. Strand should outlive TLSWebSocket.
+         */
+        explicit TLSWebSocket(boost::asio::io_service::strand& strand);
+
         /**
          *  Calls shutdown().
          */
@@ -67,6 +79,12 @@ namespace Hexicord {
          */
         void sendMessage(const std::vector<uint8_t>& message);
 
+        /**
+         *  Same as above but sends data from caller's buffer, which is
+         *  not copied.
+         */
+        void sendMessage(const uint8_t* data, size_t size);
+
         /**
          *  Read message if any, blocks if there is no message.
          *
@@ -84,7 +102,8 @@ namespace Hexicord {
          *          in std::shared_ptr for this function to work correctly.
          *          Otherwise UB will occur.
          *
-         *  This method is thread-safe.
+         *  This method is thread-safe, but only one read can be in progress.
+         *  If socket has strand, it should be called from that strand.
          */
         void asyncReadMessage(const AsyncReadCallback& callback);
 
@@ -96,10 +115,18 @@ namespace Hexicord {
          *          in std::shared_ptr for this function to work correctly.
          *          Otherwise UB will occur.
          *
-         *  This method is NOT thread-safe.
+         *  This method is NOT thread-safe, message buffer should live until
+         *  callback is called. If socket has strand, it should be called
+         *  from that strand.
          */
         void asyncSendMessage(const std::vector<uint8_t>& message, const AsyncSendCallback& callback);
 
+        /**
+         *  Same as above but sends data from caller's buffer, which is
+         *  not copied.
+         */
+        void asyncSendMessage(const uint8_t* data, size_t size, const AsyncSendCallback& callback);
+
         /**
          *  Perform TCP handshake, TLS handshake and WS handshake.
          *
@@ -126,6 +153,7 @@ namespace Hexicord {
     private:
         const std::string servername;
         std::mutex connectionMutex;
+        boost::asio::io_service::strand* strand = nullptr;
     };
 }
 
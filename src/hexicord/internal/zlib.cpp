@@ -25,6 +25,7 @@
 #include <cstring> // memcpy, size_t
 #include <cassert> // assert
 #include <string>  // std::string
+#include <stdexcept> // std::runtime_error
 #include <zlib.h>  // z_stream inflate inflateEnd
 
 // Closer to trivial message size => better.
@@ -71,6 +72,65 @@ namespace Zlib {
         inflateEnd(&stream);
         return result;
     }
+
+    struct InflaterState {
+        InflaterState() {
+            stream.zalloc   = nullptr;
+            stream.zfree    = nullptr;
+            stream.opaque   = nullptr;
+            stream.avail_in = 0;
+            stream.next_in  = nullptr;
+        }
+
+        ~InflaterState() {
+            if (initialized) inflateEnd(&stream);
+        }
+
+        z_stream stream;
+        bool initialized = false;
+        bool finished = false;
+    };
+
+    Inflater::Inflater(int windowBits)
+        : state(std::make_shared<InflaterState>()) {
+
+        if (inflateInit2(&state->stream, windowBits) != Z_OK) {
+            throw std::runtime_error("Failed to initialize zlib stream.");
+        }
+        state->initialized = true;
+    }
+
+    void Inflater::feed(const uint8_t* data, size_t size, std::vector<uint8_t>& output) {
+        z_stream& stream = state->stream;
+        stream.next_in  = const_cast<uint8_t*>(data);
+        stream.avail_in = uInt(size);
+
+        // Output is written right into vector's tail, which grows as needed.
+        // Inflate is called again while it fills whole buffer, even if input
+        // is consumed, because it can still hold decoded bytes.
+        while (!state->finished) {
+            size_t offset = output.size();
+            output.resize(offset + ZlibBufferSize);
+            stream.next_out  = output.data() + offset;
+            stream.avail_out = ZlibBufferSize;
+
+            int status = inflate(&stream, Z_NO_FLUSH);
+            output.resize(offset + ZlibBufferSize - stream.avail_out);
+
+            if (status == Z_STREAM_END) {
+                state->finished = true;
+            } else if (status != Z_OK && status != Z_BUF_ERROR) {
+                throw std::runtime_error(std::string("Failed to decompress data: ") +
+                                         (stream.msg ? stream.msg : "unknown error"));
+            }
+
+            if (stream.avail_in == 0 && stream.avail_out != 0) break;
+        }
+    }
+
+    bool Inflater::finished() const {
+        return state->finished;
+    }
 }} // namespace Zlib
 
 #endif
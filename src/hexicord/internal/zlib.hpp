@@ -26,11 +26,44 @@
 #ifdef HEXICORD_ZLIB
 
 #include <cstdint>
+#include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace Hexicord {
     namespace Zlib {
         std::vector<uint8_t> decompress(const std::vector<uint8_t>& input);
+
+        struct InflaterState;
+
+        /**
+         * Streaming decompressor, input can be passed in chunks of any size
+         * as it arrives.
+         */
+        class Inflater {
+        public:
+            /**
+             * \param windowBits Passed to inflateInit2, default value
+             *                   accepts both zlib and gzip streams.
+             */
+            explicit Inflater(int windowBits = 15 + 32);
+
+            Inflater(const Inflater&) = delete;
+            Inflater& operator=(const Inflater&) = delete;
+
+            /**
+             * Decompress chunk and append result to output.
+             *
+             * \throws std::runtime_error if input is malformed.
+             */
+            void feed(const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+
+            /// True if end of compressed stream is reached.
+            bool finished() const;
+
+        private:
+            std::shared_ptr<InflaterState> state;
+        };
     }
 }
 #endif // HEXICORD_ZLIB
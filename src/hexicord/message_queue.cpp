@@ -0,0 +1,169 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/message_queue.hpp"
+
+#include <exception>                            // std::current_exception, std::exception_ptr
+#include <utility>                              // std::move
+#include "hexicord/config.hpp"                  // HEXICORD_DEBUG_LOG
+#include "hexicord/internal/worker_pool.hpp"    // Hexicord::WorkerPool
+
+#ifdef HEXICORD_DEBUG_LOG
+    #include <iostream>
+    #define DEBUG_MSG(msg) do { std::cerr << "message_queue.cpp:" << __LINE__ << "\t" << (msg) << '\n'; } while (false)
+#else
+    #define DEBUG_MSG(msg)
+#endif
+
+namespace Hexicord {
+    constexpr size_t MessageQueue::MaxMessageSize;
+
+    MessageQueue::MessageQueue(RestClient& client, unsigned threadsCount, RequestPriority priority)
+        : client(client)
+        , priority(priority)
+        , workers(std::make_shared<WorkerPool>(threadsCount)) {}
+
+    MessageQueue::~MessageQueue() {
+        // Finish drain tasks while members they use are still alive.
+        workers.reset();
+    }
+
+    std::future<nlohmann::json> MessageQueue::send(Snowflake channelId, const std::string& text) {
+        std::future<nlohmann::json> result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            Channel& channel = channels[channelId];
+            channel.messages.push_back({ text, std::promise<nlohmann::json>() });
+            result = channel.messages.back().promise.get_future();
+            ++pendingCount;
+
+            // Otherwise message will be picked up by running drain.
+            if (channel.busy) return result;
+            channel.busy = true;
+        }
+
+        workers->post([this, channelId]() { drain(channelId); });
+        return result;
+    }
+
+    size_t MessageQueue::pending() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pendingCount;
+    }
+
+    std::vector<std::string> MessageQueue::split(const std::string& text, size_t maxSize) {
+        std::vector<std::string> parts;
+
+        size_t begin = 0;
+        while (text.size() - begin > maxSize) {
+            size_t end = text.rfind('\n', begin + maxSize);
+            if (end == std::string::npos || end <= begin) end = text.rfind(' ', begin + maxSize);
+            if (end == std::string::npos || end <= begin) {
+                // No good place, cut at character boundary.
+                end = begin + maxSize;
+                while (end > begin && (uint8_t(text[end]) & 0xC0) == 0x80) --end;
+                if (end == begin) end = begin + maxSize; // Not UTF-8 anyway.
+                parts.push_back(text.substr(begin, end - begin));
+                begin = end;
+            } else {
+                // Separator itself is dropped.
+                parts.push_back(text.substr(begin, end - begin));
+                begin = end + 1;
+            }
+        }
+        // Empty if separator was exactly at limit, Discord rejects empty messages.
+        if (begin < text.size()) parts.push_back(text.substr(begin));
+        return parts;
+    }
+
+    void MessageQueue::drain(Snowflake channelId) {
+        PriorityScope priorityScope(priority);
+
+        while (true) {
+            // Take everything queued so far, merging it into as few messages
+            // as possible. Promises are fulfilled with last message containing
+            // their text.
+            std::vector<PendingMessage> batch;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                Channel& channel = channels[channelId];
+                if (channel.messages.empty()) {
+                    channels.erase(channelId);
+                    return;
+                }
+
+                batch.reserve(channel.messages.size());
+                for (PendingMessage& message : channel.messages) batch.push_back(std::move(message));
+                channel.messages.clear();
+                pendingCount -= batch.size();
+            }
+            DEBUG_MSG(std::string("Sending ") + std::to_string(batch.size()) + " queued messages to " + std::to_string(channelId));
+
+            size_t next = 0;
+            while (next < batch.size()) {
+                std::string text;
+                size_t end = next + 1;
+                const bool oversized = batch[next].text.size() > MaxMessageSize;
+                if (!oversized) {
+                    text = std::move(batch[next].text);
+                    for (end = next + 1; end < batch.size(); ++end) {
+                        if (text.size() + 1 + batch[end].text.size() > MaxMessageSize) break;
+                        text += '\n';
+                        text += batch[end].text;
+                    }
+                }
+
+                if (oversized) {
+                    // Sent alone, in parts. Failed part doesn't stop the rest,
+                    // promise gets first error only after all parts are tried.
+                    nlohmann::json message;
+                    std::exception_ptr error;
+                    for (const std::string& part : split(batch[next].text)) {
+                        try {
+                            message = client.sendTextMessage(channelId, part);
+                        } catch (...) {
+                            DEBUG_MSG(std::string("Failed to send part of message to ") + std::to_string(channelId));
+                            if (!error) error = std::current_exception();
+                        }
+                    }
+                    if (error) {
+                        batch[next].promise.set_exception(error);
+                    } else {
+                        batch[next].promise.set_value(message);
+                    }
+                    next = end;
+                    continue;
+                }
+
+                try {
+                    nlohmann::json message = client.sendTextMessage(channelId, text);
+                    for (size_t i = next; i < end; ++i) batch[i].promise.set_value(message);
+                } catch (...) {
+                    for (size_t i = next; i < end; ++i) batch[i].promise.set_exception(std::current_exception());
+                }
+                next = end;
+            }
+        }
+    }
+} // namespace Hexicord
@@ -0,0 +1,125 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_MESSAGE_QUEUE_HPP
+#define HEXICORD_MESSAGE_QUEUE_HPP
+
+#include <cstddef>                       // size_t
+#include <deque>                         // std::deque
+#include <future>                        // std::promise, std::future
+#include <memory>                        // std::shared_ptr
+#include <mutex>                         // std::mutex
+#include <string>                        // std::string
+#include <vector>                        // std::vector
+#include "hexicord/json.hpp"             // nlohmann::json
+#include "hexicord/rest_client.hpp"      // Hexicord::RestClient, Hexicord::RequestPriority
+#include "hexicord/snowflake_map.hpp"    // Hexicord::SnowflakeMap
+#include "hexicord/types/snowflake.hpp"  // Hexicord::Snowflake
+namespace Hexicord { class WorkerPool; }
+
+namespace Hexicord {
+    /**
+     * Outbound text messages queue with one request in flight per channel.
+     *
+     * Messages sent while previous request to same channel is in progress
+     * (for example, waiting for ratelimit) are merged: when request
+     * completes, all pending messages are joined by newline into as few
+     * messages as possible within 2000 characters limit. Text longer than
+     * limit is split at line breaks (or spaces) into several messages.
+     *
+     * ```cpp
+     * Hexicord::MessageQueue queue(rclient);
+     * for (const std::string& line : logLines) {
+     *     queue.send(logChannel, line);
+     * }
+     * ```
+     *
+     * All methods are thread-safe.
+     */
+    class MessageQueue {
+    public:
+        /// Discord's limit for message text.
+        static constexpr size_t MaxMessageSize = 2000;
+
+        /**
+         * \param client       RestClient used to perform requests. Should not be
+         *                     destroyed while MessageQueue exists.
+         * \param threadsCount Max count of channels served at once.
+         * \param priority     Priority of sent requests.
+         */
+        MessageQueue(RestClient& client, unsigned threadsCount = 2,
+                     RequestPriority priority = RequestPriority::Normal);
+
+        /**
+         * Sends all pending messages and waits for them.
+         */
+        ~MessageQueue();
+
+        MessageQueue(const MessageQueue&) = delete;
+        MessageQueue& operator=(const MessageQueue&) = delete;
+
+        /**
+         * Queue text message.
+         *
+         * Future receives object of message that contains text (last one
+         * if text was split), or exception if sending failed. If sending
+         * of some part of split text fails, remaining parts are still
+         * sent and future receives exception of first failed part.
+         */
+        std::future<nlohmann::json> send(Snowflake channelId, const std::string& text);
+
+        /// Count of queued messages not sent yet.
+        size_t pending() const;
+
+        /**
+         * Split text into parts not longer than maxSize bytes, preferring
+         * to cut at line breaks, then at spaces. UTF-8 sequences are never
+         * cut, empty parts are never returned.
+         */
+        static std::vector<std::string> split(const std::string& text, size_t maxSize = MaxMessageSize);
+
+        RestClient& client;
+        const RequestPriority priority;
+    private:
+        struct PendingMessage {
+            std::string text;
+            std::promise<nlohmann::json> promise;
+        };
+
+        struct Channel {
+            std::deque<PendingMessage> messages;
+            bool busy = false;
+        };
+
+        // Sends queued messages until channel's queue is empty.
+        void drain(Snowflake channelId);
+
+        SnowflakeMap<Channel> channels;
+        size_t pendingCount = 0;
+        mutable std::mutex mutex;
+
+        // Declared last, so it's destroyed (and queue drained) first.
+        std::shared_ptr<WorkerPool> workers;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_MESSAGE_QUEUE_HPP
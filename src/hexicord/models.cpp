@@ -0,0 +1,205 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/models.hpp"
+
+#include "hexicord/json.hpp"                     // nlohmann::json::parse_error
+#include "hexicord/internal/json_reader.hpp"    // Hexicord::JsonReader
+
+namespace Hexicord {
+    namespace {
+        boost::optional<std::string> readOptionalString(JsonReader& reader) {
+            if (reader.readNull()) return boost::none;
+            return reader.readString();
+        }
+
+        std::vector<Snowflake> readSnowflakes(JsonReader& reader) {
+            std::vector<Snowflake> result;
+            if (reader.readNull()) return result;
+
+            reader.beginArray();
+            while (reader.nextElement()) {
+                result.push_back(reader.readSnowflake());
+            }
+            return result;
+        }
+
+        void read(JsonReader& reader, User& user);
+        void read(JsonReader& reader, Role& role);
+        void read(JsonReader& reader, Member& member);
+        void read(JsonReader& reader, Channel& channel);
+        void read(JsonReader& reader, Guild& guild);
+        void read(JsonReader& reader, Message& message);
+
+        template<typename Model>
+        std::vector<Model> readArray(JsonReader& reader) {
+            std::vector<Model> result;
+            if (reader.readNull()) return result;
+
+            reader.beginArray();
+            while (reader.nextElement()) {
+                result.emplace_back();
+                read(reader, result.back());
+            }
+            return result;
+        }
+
+        void read(JsonReader& reader, User& user) {
+            if (reader.readNull()) return;
+
+            reader.beginObject();
+            boost::string_view key;
+            while (reader.nextKey(key)) {
+                if      (key == "id")            user.id            = reader.readSnowflake();
+                else if (key == "username")      user.username      = reader.readString();
+                else if (key == "discriminator") user.discriminator = reader.readString();
+                else if (key == "avatar")        user.avatar        = readOptionalString(reader);
+                else if (key == "bot")           user.bot           = reader.readBool();
+                else reader.skip();
+            }
+        }
+
+        void read(JsonReader& reader, Role& role) {
+            reader.beginObject();
+            boost::string_view key;
+            while (reader.nextKey(key)) {
+                if      (key == "id")          role.id          = reader.readSnowflake();
+                else if (key == "name")        role.name        = reader.readString();
+                else if (key == "color")       role.color       = uint32_t(reader.readUInt());
+                else if (key == "hoist")       role.hoist       = reader.readBool();
+                else if (key == "position")    role.position    = int(reader.readInt());
+                else if (key == "permissions") role.permissions = reader.readUInt();
+                else if (key == "managed")     role.managed     = reader.readBool();
+                else if (key == "mentionable") role.mentionable = reader.readBool();
+                else reader.skip();
+            }
+        }
+
+        void read(JsonReader& reader, Member& member) {
+            reader.beginObject();
+            boost::string_view key;
+            while (reader.nextKey(key)) {
+                if      (key == "user")      read(reader, member.user);
+                else if (key == "guild_id")  member.guildId  = reader.readSnowflake();
+                else if (key == "nick")      member.nick     = readOptionalString(reader);
+                else if (key == "roles")     member.roles    = readSnowflakes(reader);
+                else if (key == "joined_at") member.joinedAt = reader.readString();
+                else if (key == "deaf")      member.deaf     = reader.readBool();
+                else if (key == "mute")      member.mute     = reader.readBool();
+                else reader.skip();
+            }
+        }
+
+        void read(JsonReader& reader, Channel& channel) {
+            reader.beginObject();
+            boost::string_view key;
+            while (reader.nextKey(key)) {
+                if      (key == "id")              channel.id            = reader.readSnowflake();
+                else if (key == "type")            channel.type          = int(reader.readInt());
+                else if (key == "guild_id")        channel.guildId       = reader.readSnowflake();
+                else if (key == "name")            channel.name          = reader.readString();
+                else if (key == "topic")           channel.topic         = readOptionalString(reader);
+                else if (key == "position")        channel.position      = int(reader.readInt());
+                else if (key == "last_message_id") channel.lastMessageId = reader.readSnowflake();
+                else if (key == "parent_id")       channel.parentId      = reader.readSnowflake();
+                else if (key == "nsfw")            channel.nsfw          = reader.readBool();
+                else reader.skip();
+            }
+        }
+
+        void read(JsonReader& reader, Guild& guild) {
+            reader.beginObject();
+            boost::string_view key;
+            while (reader.nextKey(key)) {
+                if      (key == "id")           guild.id          = reader.readSnowflake();
+                else if (key == "name")         guild.name        = reader.readString();
+                else if (key == "icon")         guild.icon        = readOptionalString(reader);
+                else if (key == "owner_id")     guild.ownerId     = reader.readSnowflake();
+                else if (key == "region")       guild.region      = reader.readString();
+                else if (key == "roles")        guild.roles       = readArray<Role>(reader);
+                else if (key == "channels")     guild.channels    = readArray<Channel>(reader);
+                else if (key == "members")      guild.members     = readArray<Member>(reader);
+                else if (key == "member_count") guild.memberCount = unsigned(reader.readUInt());
+                else if (key == "large")        guild.large       = reader.readBool();
+                else if (key == "unavailable")  guild.unavailable = reader.readBool();
+                else reader.skip();
+            }
+        }
+
+        void read(JsonReader& reader, Message& message) {
+            reader.beginObject();
+            boost::string_view key;
+            while (reader.nextKey(key)) {
+                if      (key == "id")               message.id              = reader.readSnowflake();
+                else if (key == "channel_id")       message.channelId       = reader.readSnowflake();
+                else if (key == "guild_id")         message.guildId         = reader.readSnowflake();
+                else if (key == "author")           read(reader, message.author);
+                else if (key == "webhook_id")       message.webhookId       = reader.readSnowflake();
+                else if (key == "content")          message.content         = reader.readString();
+                else if (key == "timestamp")        message.timestamp       = reader.readString();
+                else if (key == "edited_timestamp") message.editedTimestamp = readOptionalString(reader);
+                else if (key == "tts")              message.tts             = reader.readBool();
+                else if (key == "mention_everyone") message.mentionEveryone = reader.readBool();
+                else if (key == "pinned")           message.pinned          = reader.readBool();
+                else if (key == "mentions")         message.mentions        = readArray<User>(reader);
+                else if (key == "mention_roles")    message.mentionRoles    = readSnowflakes(reader);
+                else if (key == "type")             message.type            = int(reader.readInt());
+                else reader.skip();
+            }
+        }
+
+        template<typename Model>
+        Model decode(boost::string_view json) {
+            JsonReader reader(json);
+            Model result;
+            read(reader, result);
+            if (!reader.atEnd()) {
+                throw nlohmann::json::parse_error::create(101, json.size(), "trailing characters after object");
+            }
+            return result;
+        }
+    } // namespace
+
+    User User::fromJson(boost::string_view json) {
+        return decode<User>(json);
+    }
+
+    Role Role::fromJson(boost::string_view json) {
+        return decode<Role>(json);
+    }
+
+    Member Member::fromJson(boost::string_view json) {
+        return decode<Member>(json);
+    }
+
+    Channel Channel::fromJson(boost::string_view json) {
+        return decode<Channel>(json);
+    }
+
+    Guild Guild::fromJson(boost::string_view json) {
+        return decode<Guild>(json);
+    }
+
+    Message Message::fromJson(boost::string_view json) {
+        return decode<Message>(json);
+    }
+} // namespace Hexicord
@@ -0,0 +1,142 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#ifndef HEXICORD_MODELS_HPP
+#define HEXICORD_MODELS_HPP
+
+#include <cstdint>                          // uint64_t, uint32_t
+#include <string>                           // std::string
+#include <vector>                           // std::vector
+#include <boost/optional.hpp>               // boost::optional
+#include <boost/utility/string_view.hpp>    // boost::string_view
+#include "hexicord/types/snowflake.hpp"     // Hexicord::Snowflake
+
+/**
+ * \file models.hpp
+ *
+ * Typed representation of most used Discord objects.
+ *
+ * Each model have fromJson(boost::string_view) which decodes object directly
+ * from JSON text without building nlohmann::json DOM. Snowflakes are parsed in
+ * place and fields not present in model are skipped without allocations.
+ * Missing or null fields are left with default values.
+ *
+ * Combine with \ref EventDispatcher::addTypedHandler to receive events
+ * without DOM construction at all.
+ *
+ * All fromJson functions throw nlohmann::json::parse_error on malformed input.
+ */
+
+namespace Hexicord {
+    struct User {
+        Snowflake id;
+        std::string username;
+        std::string discriminator;
+        boost::optional<std::string> avatar;
+        bool bot = false;
+
+        static User fromJson(boost::string_view json);
+    };
+
+    struct Role {
+        Snowflake id;
+        std::string name;
+        uint32_t color = 0;
+        bool hoist = false;
+        int position = 0;
+        uint64_t permissions = 0;
+        bool managed = false;
+        bool mentionable = false;
+
+        static Role fromJson(boost::string_view json);
+    };
+
+    struct Member {
+        User user;
+        /// Present only in gateway events.
+        Snowflake guildId;
+        boost::optional<std::string> nick;
+        std::vector<Snowflake> roles;
+        std::string joinedAt;
+        bool deaf = false;
+        bool mute = false;
+
+        static Member fromJson(boost::string_view json);
+    };
+
+    struct Channel {
+        Snowflake id;
+        int type = 0;
+        Snowflake guildId;
+        std::string name;
+        boost::optional<std::string> topic;
+        int position = 0;
+        Snowflake lastMessageId;
+        Snowflake parentId;
+        bool nsfw = false;
+
+        static Channel fromJson(boost::string_view json);
+    };
+
+    struct Guild {
+        Snowflake id;
+        std::string name;
+        boost::optional<std::string> icon;
+        Snowflake ownerId;
+        std::string region;
+        std::vector<Role> roles;
+
+        // Following fields are sent only in GUILD_CREATE event.
+        std::vector<Channel> channels;
+        std::vector<Member> members;
+        unsigned memberCount = 0;
+        bool large = false;
+        bool unavailable = false;
+
+        static Guild fromJson(boost::string_view json);
+    };
+
+    struct Message {
+        Snowflake id;
+        Snowflake channelId;
+        /// Present only in gateway events.
+        Snowflake guildId;
+        /// For messages sent by webhook author.id is webhook ID.
+        User author;
+        /// Non-zero if message is sent by webhook.
+        Snowflake webhookId;
+        std::string content;
+        std::string timestamp;
+        boost::optional<std::string> editedTimestamp;
+        bool tts = false;
+        bool mentionEveryone = false;
+        bool pinned = false;
+        std::vector<User> mentions;
+        std::vector<Snowflake> mentionRoles;
+        int type = 0;
+
+        static Message fromJson(boost::string_view json);
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_MODELS_HPP
@@ -0,0 +1,119 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/paginator.hpp"
+
+#include <utility>              // std::move
+
+namespace Hexicord {
+    namespace {
+        Snowflake itemId(const nlohmann::json& item) {
+            return item["id"].get<Snowflake>();
+        }
+    } // namespace
+
+    Paginator::Paginator(FetchFunction fetch, IdFunction id, Direction direction, Snowflake start, unsigned pageSize,
+                         RequestPriority priority)
+        : fetch(std::move(fetch))
+        , id(std::move(id))
+        , direction(direction)
+        , pageSize(pageSize)
+        , priority(priority) {
+
+        prefetch(start);
+    }
+
+    bool Paginator::next(nlohmann::json& page) {
+        if (finished) return false;
+
+        nlohmann::json received;
+        try {
+            received = pending.get();
+        } catch (...) {
+            finished = true;
+            throw;
+        }
+
+        if (!received.is_array() || received.empty()) {
+            finished = true;
+            return false;
+        }
+
+        if (received.size() < pageSize) {
+            finished = true;
+        } else {
+            Snowflake cursor = id(received.front());
+            for (const nlohmann::json& item : received) {
+                Snowflake itemId = id(item);
+                if (direction == Ascending ? itemId > cursor : itemId < cursor) cursor = itemId;
+            }
+            prefetch(cursor);
+        }
+
+        page = std::move(received);
+        return true;
+    }
+
+    void Paginator::prefetch(Snowflake cursor) {
+        FetchFunction fetchCopy = fetch;
+        unsigned limit = pageSize;
+        RequestPriority requestPriority = priority;
+
+        // Response is parsed in background thread too.
+        pending = std::async(std::launch::async, [fetchCopy, cursor, limit, requestPriority]() {
+            PriorityScope scope(requestPriority);
+            return fetchCopy(cursor, limit);
+        });
+    }
+
+    Paginator Paginator::messagesAfter(RestClient& client, Snowflake channelId, Snowflake after, unsigned pageSize,
+                                        RequestPriority priority) {
+        RestClient* clientPtr = &client;
+        return Paginator([clientPtr, channelId](Snowflake cursor, unsigned limit) {
+            return clientPtr->getMessages(channelId, RestClient::After{ cursor }, limit);
+        }, itemId, Ascending, after, pageSize, priority);
+    }
+
+    Paginator Paginator::messagesBefore(RestClient& client, Snowflake channelId, Snowflake before, unsigned pageSize,
+                                         RequestPriority priority) {
+        RestClient* clientPtr = &client;
+        return Paginator([clientPtr, channelId](Snowflake cursor, unsigned limit) {
+            return clientPtr->getMessages(channelId, RestClient::Before{ cursor }, limit);
+        }, itemId, Descending, before, pageSize, priority);
+    }
+
+    Paginator Paginator::members(RestClient& client, Snowflake guildId, unsigned pageSize, RequestPriority priority) {
+        RestClient* clientPtr = &client;
+        return Paginator([clientPtr, guildId](Snowflake cursor, unsigned limit) {
+            return clientPtr->getMembers(guildId, limit, cursor);
+        }, [](const nlohmann::json& member) {
+            return member["user"]["id"].get<Snowflake>();
+        }, Ascending, 0, pageSize, priority);
+    }
+
+    Paginator Paginator::userGuilds(RestClient& client, unsigned pageSize, RequestPriority priority) {
+        RestClient* clientPtr = &client;
+        return Paginator([clientPtr](Snowflake cursor, unsigned limit) {
+            return clientPtr->getUserGuilds(uint16_t(limit), cursor);
+        }, itemId, Ascending, 0, pageSize, priority);
+    }
+} // namespace Hexicord
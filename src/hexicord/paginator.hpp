@@ -0,0 +1,136 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_PAGINATOR_HPP
+#define HEXICORD_PAGINATOR_HPP
+
+#include <functional>                    // std::function
+#include <future>                        // std::future
+#include "hexicord/json.hpp"             // nlohmann::json
+#include "hexicord/rest_client.hpp"      // Hexicord::RestClient, Hexicord::RequestPriority
+#include "hexicord/types/snowflake.hpp"  // Hexicord::Snowflake
+
+namespace Hexicord {
+    /**
+     * Iterates over paginated endpoint page by page, fetching next page
+     * in background while current one is processed.
+     *
+     * At most two pages are held in memory: one returned to caller and
+     * one being fetched.
+     *
+     * ```cpp
+     * auto messages = Hexicord::Paginator::messagesBefore(rclient, channelId);
+     * nlohmann::json page;
+     * while (messages.next(page)) {
+     *     for (const auto& message : page) export(message);
+     * }
+     * ```
+     *
+     * RestClient should be created with more than one connection to get
+     * benefit from prefetching if it's used by other threads at same time.
+     *
+     * Every factory accepts priority of page requests, it's Background by
+     * default so export doesn't delay interactive requests sharing same
+     * bucket.
+     */
+    class Paginator {
+    public:
+        /// Should return page of at most limit items after (or before) cursor.
+        using FetchFunction = std::function<nlohmann::json(Snowflake cursor, unsigned limit)>;
+
+        /// Should return id of page item which is used as cursor.
+        using IdFunction = std::function<Snowflake(const nlohmann::json& item)>;
+
+        enum Direction {
+            Ascending,  ///< Next cursor is largest id in page.
+            Descending  ///< Next cursor is smallest id in page.
+        };
+
+        /**
+         * Construct paginator for arbitrary endpoint, first page request
+         * is sent immediately.
+         *
+         * \param fetch     Function that performs request.
+         * \param id        Function that extracts item id.
+         * \param start     Cursor for first page.
+         * \param pageSize  Items per page, pagination stops when page
+         *                  with fewer items is received.
+         * \param priority  Priority of page requests.
+         */
+        Paginator(FetchFunction fetch, IdFunction id, Direction direction, Snowflake start, unsigned pageSize,
+                  RequestPriority priority = RequestPriority::Background);
+
+        Paginator(Paginator&&) = default;
+        Paginator& operator=(Paginator&&) = default;
+
+        /**
+         * Wait for next page and start fetching one after it.
+         *
+         * Exceptions thrown by request are rethrown here.
+         *
+         * \returns false if there are no more pages, page is not
+         *          changed in this case.
+         */
+        bool next(nlohmann::json& page);
+
+        /**
+         * Iterate over messages in channel from older to newer, starting
+         * after specified id.
+         */
+        static Paginator messagesAfter(RestClient& client, Snowflake channelId, Snowflake after = 0,
+                                       unsigned pageSize = 100,
+                                       RequestPriority priority = RequestPriority::Background);
+
+        /**
+         * Iterate over messages in channel from newer to older, starting
+         * before specified id (or from latest message if 0).
+         */
+        static Paginator messagesBefore(RestClient& client, Snowflake channelId, Snowflake before = 0,
+                                        unsigned pageSize = 100,
+                                        RequestPriority priority = RequestPriority::Background);
+
+        /**
+         * Iterate over all guild members sorted by user id.
+         */
+        static Paginator members(RestClient& client, Snowflake guildId, unsigned pageSize = 1000,
+                                 RequestPriority priority = RequestPriority::Background);
+
+        /**
+         * Iterate over guilds of current user.
+         */
+        static Paginator userGuilds(RestClient& client, unsigned pageSize = 100,
+                                    RequestPriority priority = RequestPriority::Background);
+    private:
+        void prefetch(Snowflake cursor);
+
+        FetchFunction fetch;
+        IdFunction id;
+        Direction direction;
+        unsigned pageSize;
+        RequestPriority priority;
+
+        std::future<nlohmann::json> pending;
+        bool finished = false;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_PAGINATOR_HPP
@@ -21,6 +21,7 @@
 
 #include "hexicord/ratelimit_lock.hpp"
 
+#include <algorithm>            // std::min, std::max
 #include <chrono>               // std::chrono::seconds
 #include <thread>               // std::this_thread::sleep_for
 #include "hexicord/config.hpp"  // HEXICORD_DEBUG_LOG
@@ -32,39 +33,53 @@
     #define DEBUG_MSG(msg)
 #endif
 
+namespace {
+    // Delay between wakeups of adjacent priority classes after reset.
+    constexpr unsigned wakeupStaggerMs = 100;
+}
+
+Hexicord::RatelimitLock::RatelimitLock(RatelimitLock&& other) {
+    std::lock_guard<std::mutex> lock(other.mutex);
+    queue = std::move(other.queue);
+    ratelimitPointers = std::move(other.ratelimitPointers);
+}
+
 int Hexicord::RatelimitLock::remaining(const std::string& route) {
+    std::lock_guard<std::mutex> lock(mutex);
     auto it = ratelimitPointers.find(route);
     return it != ratelimitPointers.end() ? it->second->remaining : -1;
 }
 
 int Hexicord::RatelimitLock::total(const std::string& route) {
+    std::lock_guard<std::mutex> lock(mutex);
     auto it = ratelimitPointers.find(route);
     return it != ratelimitPointers.end() ? it->second->total : -1;
 }
 
 time_t Hexicord::RatelimitLock::resetTime(const std::string& route) {
+    std::lock_guard<std::mutex> lock(mutex);
     auto it = ratelimitPointers.find(route);
     return it != ratelimitPointers.end() ? it->second->resetTime : -1;
 }
 
-void Hexicord::RatelimitLock::down(const std::string& route) {
-    auto it = ratelimitPointers.find(route);
-
-    // We can't predict limit hit in this case, so assume we don't hit it.
-    if (it == ratelimitPointers.end()) {
-        DEBUG_MSG(std::string("Can't predict hit for route (no information) ") + route);
-        return;
-    }
+unsigned Hexicord::RatelimitLock::reserved(unsigned total, unsigned priorityClass) {
+    if (total == 0) return 0;
+    return std::min(total - 1, std::max(priorityClass, total * priorityClass / 4));
+}
 
-    RatelimitInfo& routeInfo = *it->second;
+void Hexicord::RatelimitLock::down(const std::string& route, unsigned priorityClass) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        auto it = ratelimitPointers.find(route);
 
-    --routeInfo.remaining;
+        // We can't predict limit hit in this case, so assume we don't hit it.
+        if (it == ratelimitPointers.end()) {
+            DEBUG_MSG(std::string("Can't predict hit for route (no information) ") + route);
+            return;
+        }
 
-    DEBUG_MSG(std::string("Ratelimit semaphore acquire for route ") + route +
-              " total=" + std::to_string(routeInfo.total) + 
-              ", remaining=" + std::to_string(routeInfo.remaining));
+        RatelimitInfo& routeInfo = *it->second;
 
-    if (routeInfo.remaining == 0) {
         if (routeInfo.resetTime <= std::time(nullptr)) {
             DEBUG_MSG(std::string("Ratelimit information for route ") + route + " is outdated, can't predict hit!");
             queue.erase(it->second);
@@ -72,14 +87,35 @@ void Hexicord::RatelimitLock::down(const std::string& route) {
             return;
         }
 
-        DEBUG_MSG(std::string("Ratelimit hit for route ") + route + ", blocking until " +
-                  std::to_string(routeInfo.resetTime));
+        if (routeInfo.remaining > reserved(routeInfo.total, priorityClass)) {
+            --routeInfo.remaining;
 
-        std::this_thread::sleep_for(std::chrono::seconds(routeInfo.resetTime - std::time(nullptr)));
+            DEBUG_MSG(std::string("Ratelimit semaphore acquire for route ") + route +
+                      " total=" + std::to_string(routeInfo.total) +
+                      ", remaining=" + std::to_string(routeInfo.remaining));
+            return;
+        }
 
-        // we also erase information after, so it can't be outdated.
-        queue.erase(it->second);
-        ratelimitPointers.erase(it);
+        const time_t resetTime = routeInfo.resetTime;
+        DEBUG_MSG(std::string("Ratelimit hit for route ") + route + " (class " + std::to_string(priorityClass) +
+                  "), blocking until " + std::to_string(resetTime));
+
+        // Don't block other routes while sleeping. Lower classes wake up a
+        // bit later, so after reset higher ones go first and refresh info,
+        // which lower ones then check again.
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::seconds(resetTime - std::time(nullptr)) +
+                                    std::chrono::milliseconds(wakeupStaggerMs * priorityClass));
+        lock.lock();
+
+        // we also erase information after, so it can't be outdated (unless
+        // it's already refreshed by other request).
+        it = ratelimitPointers.find(route);
+        if (it != ratelimitPointers.end() && it->second->resetTime <= resetTime) {
+            queue.erase(it->second);
+            ratelimitPointers.erase(it);
+        }
+        if (priorityClass == 0) return;
     }
 }
 
@@ -93,9 +129,12 @@ void Hexicord::RatelimitLock::refreshInfo(const std::string& route,
               ", total=" + std::to_string(total) +
               ", resetTime=" + std::to_string(resetTime));
 
+    std::lock_guard<std::mutex> lock(mutex);
     auto ratelimitItIt = ratelimitPointers.find(route);
     if (ratelimitItIt != ratelimitPointers.end()) {
-        queue.push_back({ route, remaining, total, resetTime });
+        // Update in place and move to back, so it's removed last.
+        *ratelimitItIt->second = { route, remaining, total, resetTime };
+        queue.splice(queue.end(), queue, ratelimitItIt->second);
     } else {
         if (queue.size() == HEXICORD_RATELIMIT_CACHE_SIZE) {
             ratelimitPointers.erase(ratelimitPointers.find(queue.front().route));
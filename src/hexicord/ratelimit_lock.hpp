@@ -27,15 +27,24 @@
 #include <string>           // std::string
 #include <functional>       // std::function
 #include <list>             // std::list
+#include <mutex>            // std::mutex
 
 namespace Hexicord
 {
     /**
      * Class that implements semaphore-like locking based on Discord's
      * per-route rate limits.
+     *
+     * All methods are thread-safe. Threads waiting for reset don't hold
+     * the lock, so requests to other routes are not blocked.
      */
     class RatelimitLock {
     public:
+        RatelimitLock() = default;
+
+        // Needed to keep RestClient movable, other should not be used concurrently.
+        RatelimitLock(RatelimitLock&& other);
+
         /**
          * Requests count that can be made using this
          * route until resetTime(route).
@@ -61,11 +70,26 @@ namespace Hexicord
         time_t resetTime(const std::string& route);
         
         /**
-         * Called before perfoming request, block until reset time if rate limit hit.
+         * Called before perfoming request, block until reset time if there
+         * are no remaining requests for route.
+         *
+         * Part of each route's requests is reserved for higher priority
+         * classes (0 is highest): request of class N also blocks if only
+         * reserved(total, N) requests remain, so interactive requests
+         * still find free requests when background ones drained route.
+         * After reset lower classes wake up later and check again, so
+         * higher ones are served first.
          *
          * **Should not be called by user code directly.**
          */
-        void down(const std::string& route);
+        void down(const std::string& route, unsigned priorityClass = 0);
+
+        /**
+         * Count of requests kept for classes higher than priorityClass:
+         * quarter of total per class step, but at least one per step and
+         * never whole limit.
+         */
+        static unsigned reserved(unsigned total, unsigned priorityClass);
 
         /**
          * Called after request in order to update information about ratelimits.
@@ -90,6 +114,9 @@ namespace Hexicord
 
         std::list<RatelimitInfo> queue;
         std::unordered_map<std::string, decltype(queue)::iterator> ratelimitPointers;
+
+        // Guards queue and ratelimitPointers.
+        std::mutex mutex;
     };
 } // namespace Hexicord
 
@@ -0,0 +1,266 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/request_batcher.hpp"
+
+#include <algorithm>                    // std::find, std::min
+#include <exception>                    // std::current_exception, std::exception_ptr
+#include "hexicord/config.hpp"          // HEXICORD_DEBUG_LOG
+
+#ifdef HEXICORD_DEBUG_LOG
+    #include <iostream>
+    #define DEBUG_MSG(msg) do { std::cerr << "request_batcher.cpp:" << __LINE__ << "\t" << (msg) << '\n'; } while (false)
+#else
+    #define DEBUG_MSG(msg)
+#endif
+
+namespace Hexicord {
+    namespace {
+        // Limits of bulk delete endpoint.
+        constexpr size_t maxBulkDelete = 100;
+
+        // Bulk delete rejects messages older than 14 days, keep some margin
+        // because batch is sent a bit later than message is checked.
+        const std::chrono::milliseconds maxBulkDeleteAge = std::chrono::hours(24 * 14) - std::chrono::minutes(1);
+
+        template<typename T>
+        void failAll(std::vector<T>& operations, std::exception_ptr exception) {
+            for (T& operation : operations) operation.promise.set_exception(exception);
+        }
+    } // namespace
+
+    RequestBatcher::RequestBatcher(RestClient& client, std::chrono::milliseconds window, RequestPriority priority)
+        : client(client)
+        , window(window)
+        , priority(priority)
+        , worker(&RequestBatcher::run, this) {}
+
+    RequestBatcher::~RequestBatcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        worker.join();
+    }
+
+    std::shared_future<void> RequestBatcher::deleteMessage(Snowflake channelId, Snowflake messageId) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        auto it = deletes.find(channelId);
+        if (it == deletes.end()) {
+            it = deletes.emplace(channelId, Batch<PendingDelete>{ Clock::now() + window, {} }).first;
+        }
+
+        it->second.operations.push_back({ messageId, std::promise<void>() });
+        std::shared_future<void> result = it->second.operations.back().promise.get_future().share();
+
+        // No point in waiting more, we can't merge more into one request.
+        if (it->second.operations.size() >= maxBulkDelete) {
+            it->second.deadline = Clock::now();
+            lock.unlock();
+            wakeup.notify_all();
+        }
+        return result;
+    }
+
+    std::shared_future<void> RequestBatcher::giveRole(Snowflake guildId, Snowflake userId, Snowflake roleId) {
+        return enqueueRoleChange(guildId, userId, roleId, true);
+    }
+
+    std::shared_future<void> RequestBatcher::takeRole(Snowflake guildId, Snowflake userId, Snowflake roleId) {
+        return enqueueRoleChange(guildId, userId, roleId, false);
+    }
+
+    std::shared_future<void> RequestBatcher::enqueueRoleChange(Snowflake guildId, Snowflake userId,
+                                                               Snowflake roleId, bool give) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        MemberKey key(guildId, userId);
+        auto it = roleChanges.find(key);
+        if (it == roleChanges.end()) {
+            it = roleChanges.emplace(key, Batch<PendingRoleChange>{ Clock::now() + window, {} }).first;
+        }
+
+        it->second.operations.push_back({ roleId, give, std::promise<void>() });
+        return it->second.operations.back().promise.get_future().share();
+    }
+
+    void RequestBatcher::flush() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            flushRequested = true;
+        }
+        wakeup.notify_all();
+    }
+
+    void RequestBatcher::run() {
+        PriorityScope scope(priority);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            Clock::time_point now = Clock::now();
+            bool sendAll = flushRequested || stopping;
+            flushRequested = false;
+
+            std::vector<std::pair<Snowflake, std::vector<PendingDelete>>> dueDeletes;
+            std::vector<std::pair<MemberKey, std::vector<PendingRoleChange>>> dueRoleChanges;
+            Clock::time_point nextDeadline = Clock::time_point::max();
+
+            for (auto it = deletes.begin(); it != deletes.end();) {
+                if (sendAll || it->second.deadline <= now) {
+                    dueDeletes.emplace_back(it->first, std::move(it->second.operations));
+                    it = deletes.erase(it);
+                } else {
+                    nextDeadline = std::min(nextDeadline, it->second.deadline);
+                    ++it;
+                }
+            }
+            for (auto it = roleChanges.begin(); it != roleChanges.end();) {
+                if (sendAll || it->second.deadline <= now) {
+                    dueRoleChanges.emplace_back(it->first, std::move(it->second.operations));
+                    it = roleChanges.erase(it);
+                } else {
+                    nextDeadline = std::min(nextDeadline, it->second.deadline);
+                    ++it;
+                }
+            }
+
+            if (!dueDeletes.empty() || !dueRoleChanges.empty()) {
+                lock.unlock();
+                for (auto& batch : dueDeletes)     sendDeletes(batch.first, batch.second);
+                for (auto& batch : dueRoleChanges) sendRoleChanges(batch.first, batch.second);
+                lock.lock();
+
+                // More operations may have been queued while we were sending.
+                continue;
+            }
+
+            if (stopping) return;
+
+            if (nextDeadline == Clock::time_point::max()) {
+                wakeup.wait(lock);
+            } else {
+                wakeup.wait_until(lock, nextDeadline);
+            }
+        }
+    }
+
+    void RequestBatcher::sendDeletes(Snowflake channelId, std::vector<PendingDelete>& operations) {
+        auto minTimestampMs = static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch() - maxBulkDeleteAge).count());
+
+        // Same message may be deleted several times in one window, but bulk
+        // delete rejects duplicate ids. Each id is deleted once and result
+        // goes to all its operations.
+        std::vector<std::vector<PendingDelete*>> unique;
+        SnowflakeMap<size_t> position;
+        for (PendingDelete& operation : operations) {
+            auto inserted = position.emplace(operation.messageId, unique.size());
+            if (inserted.second) unique.emplace_back();
+            unique[inserted.first->second].push_back(&operation);
+        }
+
+        auto resolve = [](const std::vector<PendingDelete*>& group, std::exception_ptr exception) {
+            for (PendingDelete* operation : group) {
+                if (exception) {
+                    operation->promise.set_exception(exception);
+                } else {
+                    operation->promise.set_value();
+                }
+            }
+        };
+
+        std::vector<const std::vector<PendingDelete*>*> bulk;
+        for (const std::vector<PendingDelete*>& group : unique) {
+            Snowflake messageId = group.front()->messageId;
+            if (messageId.unixTimestampMs() >= minTimestampMs) {
+                bulk.push_back(&group);
+                continue;
+            }
+
+            try {
+                client.deleteMessage(channelId, messageId);
+                resolve(group, nullptr);
+            } catch (...) {
+                resolve(group, std::current_exception());
+            }
+        }
+
+        for (size_t begin = 0; begin < bulk.size(); begin += maxBulkDelete) {
+            size_t end = std::min(begin + maxBulkDelete, bulk.size());
+
+            std::exception_ptr exception;
+            try {
+                if (end - begin == 1) {
+                    client.deleteMessage(channelId, bulk[begin]->front()->messageId);
+                } else {
+                    std::vector<Snowflake> ids;
+                    ids.reserve(end - begin);
+                    for (size_t i = begin; i < end; ++i) ids.push_back(bulk[i]->front()->messageId);
+
+                    DEBUG_MSG(std::string("Merged ") + std::to_string(ids.size()) + " message deletions.");
+                    client.deleteMessages(channelId, ids);
+                }
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            for (size_t i = begin; i < end; ++i) resolve(*bulk[i], exception);
+        }
+    }
+
+    void RequestBatcher::sendRoleChanges(const MemberKey& member, std::vector<PendingRoleChange>& operations) {
+        try {
+            if (operations.size() == 1) {
+                if (operations.front().give) {
+                    client.giveRole(member.first, member.second, operations.front().roleId);
+                } else {
+                    client.takeRole(member.first, member.second, operations.front().roleId);
+                }
+                operations.front().promise.set_value();
+                return;
+            }
+
+            std::vector<Snowflake> roles = client.getMember(member.first, member.second)["roles"]
+                                               .get<std::vector<Snowflake>>();
+            bool changed = false;
+            for (const PendingRoleChange& operation : operations) {
+                auto it = std::find(roles.begin(), roles.end(), operation.roleId);
+                if (operation.give && it == roles.end()) {
+                    roles.push_back(operation.roleId);
+                    changed = true;
+                } else if (!operation.give && it != roles.end()) {
+                    roles.erase(it);
+                    changed = true;
+                }
+            }
+
+            if (changed) {
+                DEBUG_MSG(std::string("Merged ") + std::to_string(operations.size()) + " role changes.");
+                client.setMemberRoles(member.first, member.second, roles);
+            }
+            for (PendingRoleChange& operation : operations) operation.promise.set_value();
+        } catch (...) {
+            failAll(operations, std::current_exception());
+        }
+    }
+} // namespace Hexicord
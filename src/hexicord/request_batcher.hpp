@@ -0,0 +1,151 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_REQUEST_BATCHER_HPP
+#define HEXICORD_REQUEST_BATCHER_HPP
+
+#include <chrono>                        // std::chrono::steady_clock, std::chrono::milliseconds
+#include <condition_variable>            // std::condition_variable
+#include <future>                        // std::promise, std::shared_future
+#include <map>                           // std::map
+#include <mutex>                         // std::mutex
+#include <thread>                        // std::thread
+#include <utility>                       // std::pair
+#include <vector>                        // std::vector
+#include "hexicord/rest_client.hpp"      // Hexicord::RestClient, Hexicord::RequestPriority
+#include "hexicord/snowflake_map.hpp"    // Hexicord::SnowflakeMap
+#include "hexicord/types/snowflake.hpp"  // Hexicord::Snowflake
+
+namespace Hexicord {
+    /**
+     * Collects single-item REST operations over short window and merges
+     * compatible ones into single request.
+     *
+     * - Message deletions in one channel are sent as bulk delete (up to
+     *   100 messages per request). Messages older than 14 days can't be
+     *   bulk-deleted, so they are deleted one by one. Message deleted
+     *   several times in one window is deleted once.
+     * - Role changes for one member are applied by single
+     *   \ref RestClient::setMemberRoles call (plus \ref RestClient::getMember
+     *   to get current roles).
+     *
+     * Lone operations are sent using regular single-item methods.
+     *
+     * Requests are performed by separate thread, each method returns future
+     * that will receive result (or exception) of merged request.
+     *
+     * ```cpp
+     * Hexicord::RequestBatcher batcher(rclient);
+     * for (Hexicord::Snowflake message : spamMessages) {
+     *     batcher.deleteMessage(channel, message);
+     * }
+     * ```
+     *
+     * \note Waiting for returned future takes at least window time, so
+     *       avoid doing it in gateway event handlers.
+     */
+    class RequestBatcher {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * \param client   RestClient used to perform requests. Should not be
+         *                 destroyed while RequestBatcher exists.
+         * \param window   How long operations are collected before sending
+         *                 (counted from first operation in batch).
+         * \param priority Priority of merged requests.
+         */
+        RequestBatcher(RestClient& client,
+                       std::chrono::milliseconds window = std::chrono::milliseconds(250),
+                       RequestPriority priority = RequestPriority::Background);
+
+        /**
+         * Sends all pending operations and waits for them.
+         */
+        ~RequestBatcher();
+
+        RequestBatcher(const RequestBatcher&) = delete;
+        RequestBatcher& operator=(const RequestBatcher&) = delete;
+
+        /**
+         * Delete message, see \ref RestClient::deleteMessage.
+         */
+        std::shared_future<void> deleteMessage(Snowflake channelId, Snowflake messageId);
+
+        /**
+         * Add role to member, see \ref RestClient::giveRole.
+         */
+        std::shared_future<void> giveRole(Snowflake guildId, Snowflake userId, Snowflake roleId);
+
+        /**
+         * Remove role from member, see \ref RestClient::takeRole.
+         */
+        std::shared_future<void> takeRole(Snowflake guildId, Snowflake userId, Snowflake roleId);
+
+        /**
+         * Send all pending operations now without waiting for window end.
+         */
+        void flush();
+
+        RestClient& client;
+        const std::chrono::milliseconds window;
+        const RequestPriority priority;
+    private:
+        struct PendingDelete {
+            Snowflake messageId;
+            std::promise<void> promise;
+        };
+
+        struct PendingRoleChange {
+            Snowflake roleId;
+            bool give;
+            std::promise<void> promise;
+        };
+
+        template<typename T>
+        struct Batch {
+            Clock::time_point deadline;
+            std::vector<T> operations;
+        };
+
+        using MemberKey = std::pair<Snowflake, Snowflake>; // guild, user
+
+        std::shared_future<void> enqueueRoleChange(Snowflake guildId, Snowflake userId, Snowflake roleId, bool give);
+
+        void run();
+
+        void sendDeletes(Snowflake channelId, std::vector<PendingDelete>& operations);
+        void sendRoleChanges(const MemberKey& member, std::vector<PendingRoleChange>& operations);
+
+        SnowflakeMap<Batch<PendingDelete>> deletes;
+        std::map<MemberKey, Batch<PendingRoleChange>> roleChanges;
+
+        bool flushRequested = false;
+        bool stopping = false;
+
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::thread worker;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_REQUEST_BATCHER_HPP
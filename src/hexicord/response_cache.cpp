@@ -0,0 +1,137 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/response_cache.hpp"
+
+#include <iterator>                     // std::next
+#include "hexicord/config.hpp"          // HEXICORD_DEBUG_LOG
+#include "hexicord/internal/utils.hpp"  // Utils::split
+
+#ifdef HEXICORD_DEBUG_LOG
+    #include <iostream>
+    #define DEBUG_MSG(msg) do { std::cerr << "response_cache.cpp:" << __LINE__ << "\t" << (msg) << '\n'; } while (false)
+#else
+    #define DEBUG_MSG(msg)
+#endif
+
+namespace Hexicord {
+    ResponseCache::ResponseCache(size_t maxBytes)
+        : maxBytes(maxBytes) {}
+
+    void ResponseCache::setTtl(const std::string& routePattern, std::chrono::seconds ttl,
+                               std::chrono::seconds negativeTtl) {
+        std::lock_guard<std::mutex> lock(mutex);
+        rules.push_back({ Utils::split(routePattern, '/'), ttl, negativeTtl });
+    }
+
+    bool ResponseCache::lookup(const std::string& endpoint, nlohmann::json& value, bool& negative) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = index.find(endpoint);
+        if (it == index.end()) return false;
+
+        if (it->second->expiresAt <= Clock::now()) {
+            DEBUG_MSG(std::string("Cached response expired: ") + endpoint);
+            erase(it->second);
+            return false;
+        }
+
+        // Move entry to front, so it will be evicted last.
+        entries.splice(entries.begin(), entries, it->second);
+
+        value    = entries.front().value;
+        negative = entries.front().negative;
+        return true;
+    }
+
+    void ResponseCache::store(const std::string& endpoint, const nlohmann::json& value, size_t size, bool negative) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::chrono::seconds ttl(0);
+        for (const Rule& rule : rules) {
+            if (matches(rule.pattern, endpoint)) {
+                ttl = negative ? rule.negativeTtl : rule.ttl;
+                break;
+            }
+        }
+        if (ttl.count() <= 0) return;
+
+        size_t entrySize = size + endpoint.size() + sizeof(Entry);
+        if (entrySize > maxBytes) return;
+
+        auto existing = index.find(endpoint);
+        if (existing != index.end()) erase(existing->second);
+
+        while (used + entrySize > maxBytes && !entries.empty()) {
+            DEBUG_MSG(std::string("Response cache is full, evicting ") + entries.back().endpoint);
+            erase(--entries.end());
+        }
+
+        entries.push_front({ endpoint, value, negative, entrySize, Clock::now() + ttl });
+        index.insert({ endpoint, entries.begin() });
+        used += entrySize;
+    }
+
+    void ResponseCache::invalidate(const std::string& pattern) {
+        std::vector<std::string> splittenPattern = Utils::split(pattern, '/');
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = entries.begin(); it != entries.end();) {
+            auto next = std::next(it);
+            if (matches(splittenPattern, it->endpoint)) {
+                DEBUG_MSG(std::string("Invalidating cached response: ") + it->endpoint);
+                erase(it);
+            }
+            it = next;
+        }
+    }
+
+    void ResponseCache::clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        index.clear();
+        used = 0;
+    }
+
+    size_t ResponseCache::usedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return used;
+    }
+
+    bool ResponseCache::matches(const std::vector<std::string>& pattern, const std::string& endpoint) {
+        std::vector<std::string> path = Utils::split(endpoint.substr(0, endpoint.find('?')), '/');
+        if (path.size() != pattern.size()) return false;
+
+        for (size_t i = 0; i < path.size(); ++i) {
+            const std::string& part = pattern[i];
+            bool wildcard = part.size() >= 2 && part.front() == '{' && part.back() == '}';
+            if (!wildcard && part != path[i]) return false;
+        }
+        return true;
+    }
+
+    void ResponseCache::erase(std::list<Entry>::iterator it) {
+        used -= it->size;
+        index.erase(it->endpoint);
+        entries.erase(it);
+    }
+} // namespace Hexicord
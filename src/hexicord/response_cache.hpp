@@ -0,0 +1,136 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_RESPONSE_CACHE_HPP
+#define HEXICORD_RESPONSE_CACHE_HPP
+
+#include <cstddef>              // size_t
+#include <chrono>               // std::chrono::steady_clock, std::chrono::seconds
+#include <list>                 // std::list
+#include <mutex>                // std::mutex
+#include <string>               // std::string
+#include <unordered_map>        // std::unordered_map
+#include <vector>               // std::vector
+#include "hexicord/json.hpp"    // nlohmann::json
+
+namespace Hexicord {
+    /**
+     * In-memory cache for responses of GET requests.
+     *
+     * Disabled by default, enable it by assigning instance to
+     * \ref RestClient::responseCache. Nothing is cached until you add
+     * TTL rule for route using \ref setTtl.
+     *
+     * Negative results (404 responses, thrown as \ref UnknownEntity)
+     * are cached too, with separate TTL.
+     *
+     * All methods are thread-safe.
+     */
+    class ResponseCache {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * \param maxBytes Approximate upper bound of memory used by cached
+         *                 responses. Least recently used entries are evicted
+         *                 when limit is reached.
+         */
+        explicit ResponseCache(size_t maxBytes = 4 * 1024 * 1024);
+
+        /**
+         * Cache responses for endpoints matching routePattern.
+         *
+         * Pattern is endpoint path where any segment enclosed in braces
+         * matches any single segment, like "/users/{id}" or
+         * "/guilds/{}/webhooks". First matching rule is used.
+         *
+         * \param ttl         How long successful response is cached.
+         * \param negativeTtl How long 404 response is cached, 0 to disable.
+         */
+        void setTtl(const std::string& routePattern, std::chrono::seconds ttl,
+                    std::chrono::seconds negativeTtl = std::chrono::seconds(0));
+
+        /**
+         * Look up cached response for endpoint (path with query string).
+         *
+         * \returns false if there is no valid entry, otherwise writes
+         *          cached payload to value and sets negative if entry
+         *          represents 404 response.
+         */
+        bool lookup(const std::string& endpoint, nlohmann::json& value, bool& negative);
+
+        /**
+         * Store response if there is matching TTL rule.
+         *
+         * \param size Approximate size of response in bytes (usually
+         *             size of response body).
+         */
+        void store(const std::string& endpoint, const nlohmann::json& value, size_t size, bool negative = false);
+
+        /**
+         * Remove all entries for endpoints matching pattern (same syntax as
+         * in \ref setTtl, but query string is ignored).
+         */
+        void invalidate(const std::string& pattern);
+
+        /**
+         * Remove all entries.
+         */
+        void clear();
+
+        /**
+         * Approximate memory used by entries in bytes.
+         */
+        size_t usedBytes() const;
+
+        const size_t maxBytes;
+    private:
+        struct Entry {
+            std::string endpoint;
+            nlohmann::json value;
+            bool negative;
+            size_t size;
+            Clock::time_point expiresAt;
+        };
+
+        struct Rule {
+            std::vector<std::string> pattern;
+            std::chrono::seconds ttl;
+            std::chrono::seconds negativeTtl;
+        };
+
+        static bool matches(const std::vector<std::string>& pattern, const std::string& endpoint);
+
+        void erase(std::list<Entry>::iterator it);
+
+        std::vector<Rule> rules;
+
+        // Most recently used entry is in front.
+        std::list<Entry> entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        size_t used = 0;
+
+        mutable std::mutex mutex;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_RESPONSE_CACHE_HPP
@@ -23,11 +23,18 @@
 
 #include <thread>                                     // std::this_thread::sleep_for
 #include <chrono>                                     // std::chrono::seconds, std::chrono::milliseconds
+#include <cstring>                                    // std::strlen
+#include <memory>                                     // std::atomic_load, std::atomic_store
 #include <boost/asio/io_service.hpp>                  // boost::asio::io_service
 #include <boost/beast/http/error.hpp>                 // boost::beast::http::error::end_of_stream
 #include "hexicord/exceptions.hpp"
-#include "hexicord/internal/utils.hpp"                // Utils::getRatelimitDomain, Utils::domainFromUrl
+#include "hexicord/internal/utils.hpp"                // Utils::getRatelimitDomain, Utils::makeQueryString
+#include "hexicord/internal/route.hpp"                // Hexicord::Route, Hexicord::Routes
 #include "hexicord/internal/rest.hpp"                 // Hexicord::REST
+#include "hexicord/internal/request_scheduler.hpp"    // Hexicord::RequestScheduler
+#include "hexicord/internal/resolver.hpp"             // Hexicord::DNS
+#include "hexicord/internal/json_writer.hpp"          // Hexicord::JsonWriter
+#include "hexicord/internal/json_backend.hpp"         // Hexicord::JsonBackend::parse
 
 #if defined(HEXICORD_DEBUG_LOG)
     #include <iostream>
@@ -37,102 +44,372 @@
 #endif
 
 namespace Hexicord {
-    RestClient::RestClient(boost::asio::io_service& ioService, const std::string& token) 
-        : restConnection(new REST::HTTPSConnection(ioService, "discordapp.com"))
+    namespace {
+        thread_local RequestPriority threadPriority = RequestPriority::Normal;
+
+        // Requests are synchronous, so JSON body serialized here stays
+        // untouched until request is done and buffer can be reused by
+        // next request from same thread.
+        thread_local JsonWriter bodyWriter;
+
+        // Turns per round for Interactive, Normal and Background classes.
+        const std::vector<unsigned> priorityWeights { 8, 4, 1 };
+    } // namespace
+
+    PriorityScope::PriorityScope(RequestPriority priority)
+        : previous(threadPriority) {
+
+        if (priority != RequestPriority::Inherit) threadPriority = priority;
+    }
+
+    PriorityScope::~PriorityScope() {
+        threadPriority = previous;
+    }
+
+    RestClient::RestClient(boost::asio::io_service& ioService, const std::string& token, unsigned connectionsCount,
+                           const std::string& serverName, unsigned short port, bool tls)
+        : circuitBreaker(std::make_shared<CircuitBreaker>())
         , token(token)
+        , serverName(serverName)
+        , port(port)
+        , tls(tls)
+        , scheduler(new RequestScheduler(connectionsCount, priorityWeights))
         , ioService(ioService) {
 
-        // It's strange but Discord API requires "DiscordBot" user-agent for any connections
-        // including non-bots. Referring to https://discordapp.com/developers/docs/reference#user-agent
-        restConnection->connectionHeaders.insert({ "User-Agent", "DiscordBot (" HEXICORD_GITHUB ", " HEXICORD_VERSION ")" });
+        for (unsigned i = 0; i < connectionsCount; ++i) {
+            connections.emplace_back(new REST::HTTPSConnection(ioService, serverName, port, tls));
+        }
+
+        // Address will be likely ready when first request is made.
+        DNS::prefetch(ioService, serverName, port);
+    }
+
+    std::future<void> RestClient::prewarm() {
+        return std::async(std::launch::async, [this]() {
+            // Each task holds turn while connecting, so they get different connections.
+            std::vector<std::future<void>> tasks;
+            for (size_t i = 0; i < connections.size(); ++i) {
+                tasks.push_back(std::async(std::launch::async, [this]() {
+                    RequestScheduler::Turn turn(*scheduler, unsigned(RequestPriority::Background));
+                    if (!connections[turn.slot]->isOpen()) connections[turn.slot]->open();
+                }));
+            }
+            for (std::future<void>& task : tasks) task.get();
+        });
     }
 
     std::string RestClient::getGatewayUrl() {
-        restConnection->connectionHeaders.insert({ "Authorization", std::string("Bearer ") + token });
+        std::atomic_store(&authorization, std::make_shared<const std::string>(std::string("Bearer ") + token));
 
-        nlohmann::json response = sendRestRequest("GET", "/gateway");
+        nlohmann::json response = sendRestRequest("GET", Route::make<Routes::Gateway>());
         return response["url"];
     }
 
     std::pair<std::string, int> RestClient::getGatewayUrlBot() {
-        restConnection->connectionHeaders.insert({ "Authorization", std::string("Bot ") + token });
+        std::atomic_store(&authorization, std::make_shared<const std::string>(std::string("Bot ") + token));
 
-        nlohmann::json response = sendRestRequest("GET", "/gateway/bot");
+        nlohmann::json response = sendRestRequest("GET", Route::make<Routes::GatewayBot>());
         return { response["url"].get<std::string>(), response["shards"].get<unsigned>() };
     }
 
     nlohmann::json RestClient::sendRestRequest(const std::string& method, const std::string& endpoint,
                                            const nlohmann::json& payload,
                                            const std::unordered_map<std::string, std::string>& query,
-                                           const std::vector<REST::MultipartEntity>& multipart) {
+                                           const std::vector<REST::MultipartEntity>& multipart,
+                                           RequestPriority priority) {
+
+        // Bucket key have to be guessed for arbitrary endpoint.
+        const std::string bucket = Utils::getRatelimitDomain(endpoint);
+        return performRequest(method, endpoint, bucket, bucket, payload, query, multipart, priority);
+    }
+
+    nlohmann::json RestClient::sendRestRequest(const std::string& method, const Route& route,
+                                           const nlohmann::json& payload,
+                                           const std::unordered_map<std::string, std::string>& query,
+                                           const std::vector<REST::MultipartEntity>& multipart,
+                                           RequestPriority priority) {
 
-        if (!restConnection->isOpen()) restConnection->open();
+        return performRequest(method, route.path(), route.bucket(), route.pattern(),
+                              payload, query, multipart, priority);
+    }
+
+    std::string RestClient::sendRawRequest(const std::string& method, const std::string& endpoint,
+                                           const nlohmann::json& payload,
+                                           const std::unordered_map<std::string, std::string>& query,
+                                           const std::vector<REST::MultipartEntity>& multipart,
+                                           RequestPriority priority) {
+
+        const std::string bucket = Utils::getRatelimitDomain(endpoint);
+        REST::HTTPResponse response = performRawRequest(method, endpoint, bucket, bucket, Utils::makeQueryString(query),
+                                                        payload, multipart, priority, std::string());
+
+        const std::vector<uint8_t>& body = response.body();
+        return std::string(body.begin(), body.end());
+    }
+
+    nlohmann::json RestClient::performRequest(const std::string& method,
+                                              boost::string_view endpoint,
+                                              boost::string_view bucket,
+                                              boost::string_view routeName,
+                                              const nlohmann::json& payload,
+                                              const std::unordered_map<std::string, std::string>& query,
+                                              const std::vector<REST::MultipartEntity>& multipart,
+                                              RequestPriority priority) {
+
+        const bool cacheable = responseCache && method == "GET";
+        const std::string queryString = Utils::makeQueryString(query);
+        std::string fullEndpoint;
+        if (responseCache) {
+            fullEndpoint.reserve(endpoint.size() + queryString.size());
+            fullEndpoint.append(endpoint.data(), endpoint.size()).append(queryString);
+        }
+        if (cacheable) {
+            nlohmann::json cachedResponse;
+            bool negative;
+            if (responseCache->lookup(fullEndpoint, cachedResponse, negative)) {
+                DEBUG_MSG(std::string("Using cached response for ") + fullEndpoint);
+                if (negative) throwRestError(404, cachedResponse);
+                return cachedResponse;
+            }
+        }
+
+        REST::HTTPResponse response = performRawRequest(method, endpoint, bucket, routeName, queryString,
+                                                        payload, multipart, priority,
+                                                        cacheable ? fullEndpoint : std::string());
+        if (response.body().empty()) {
+            return {};
+        }
+
+        const std::vector<uint8_t>& body = response.body();
+        nlohmann::json jsonResp = JsonBackend::parse(boost::string_view(reinterpret_cast<const char*>(body.data()), body.size()));
+
+        if (cacheable) responseCache->store(fullEndpoint, jsonResp, response.body().size());
+
+        return jsonResp;
+    }
+
+    REST::HTTPResponse RestClient::performRawRequest(const std::string& method,
+                                                     boost::string_view endpoint,
+                                                     boost::string_view bucket,
+                                                     boost::string_view routeName,
+                                                     const std::string& queryString,
+                                                     const nlohmann::json& payload,
+                                                     const std::vector<REST::MultipartEntity>& multipart,
+                                                     RequestPriority priority,
+                                                     const std::string& cacheKey) {
+
+        if (priority == RequestPriority::Inherit) priority = threadPriority;
 
         REST::HTTPRequest request;
 
         request.method  = method;
-        request.path    = restBasePath + endpoint + Utils::makeQueryString(query);
+        request.path.reserve(std::strlen(restBasePath) + endpoint.size() + queryString.size());
+        request.path.append(restBasePath).append(endpoint.data(), endpoint.size()).append(queryString);
         request.version = 11;
 
         prepareRequestBody(request, payload, multipart);
 
         request.headers.insert({ "Accept", "application/json" });
 
+        // It's strange but Discord API requires "DiscordBot" user-agent for any connections
+        // including non-bots. Referring to https://discordapp.com/developers/docs/reference#user-agent
+        request.headers.insert({ "User-Agent", "DiscordBot (" HEXICORD_GITHUB ", " HEXICORD_VERSION ")" });
+        const std::shared_ptr<const std::string> currentAuthorization = std::atomic_load(&authorization);
+        if (currentAuthorization) request.headers.insert({ "Authorization", *currentAuthorization });
+
+        const std::string circuitRoute = circuitBreaker ? routeName.to_string() : std::string();
+        const bool idempotent = RetryPolicy::isIdempotent(method);
+
+        // Keys and sizes for metrics are computed only if they are collected.
+        const std::string metricsRoute  = metrics ? routeName.to_string() : std::string();
+        const std::string metricsBucket = metrics ? bucket.to_string() : std::string();
+        uint64_t bytesSent = 0;
+        if (metrics) {
+            for (const REST::BodySegment& segment : request.body) bytesSent += segment.size();
+        }
+
+        if (circuitBreaker && !circuitBreaker->allow(circuitRoute)) {
+            throw CircuitOpen(circuitRoute);
+        }
+
+        // Records failure if attempt is left by exception other than handled
+        // below (bad body reader, decompression error, bad_alloc), otherwise
+        // probe allowed by circuit breaker would keep route blocked forever.
+        struct OutcomeGuard {
+            ~OutcomeGuard() {
+                try {
+                    if (pending && breaker) breaker->recordFailure(route);
+                } catch (...) {
+                }
+            }
+
+            CircuitBreaker* breaker;
+            const std::string& route;
+            bool pending;
+        } outcomeGuard { circuitBreaker.get(), circuitRoute, false };
+
+        // Records failure and tells whether we should stop retrying.
+        auto failed = [&](unsigned attempt) {
+            outcomeGuard.pending = false;
+            if (circuitBreaker) circuitBreaker->recordFailure(circuitRoute);
+            return attempt >= retryPolicy.maxAttempts ||
+                   (circuitBreaker && circuitBreaker->isOpen(circuitRoute));
+        };
+
+        auto sleepBeforeRetry = [&](unsigned attempt) {
+            std::chrono::milliseconds delay = retryPolicy.backoff(attempt);
+            std::this_thread::sleep_for(delay);
+            if (metrics) metrics->recordBackoff(metricsRoute, delay);
+        };
+
+        REST::HTTPResponse response;
+        for (unsigned attempt = 1;; ++attempt) {
+            outcomeGuard.pending = true;
+            if (metrics && attempt != 1) metrics->recordRetry(metricsRoute);
+
 #ifdef HEXICORD_RATELIMIT_PREDICTION 
-        // Make sure we can do request without getting ratelimited.
-        ratelimitLock.down(Utils::getRatelimitDomain(endpoint));
+            // Make sure we can do request without getting ratelimited.
+            RestMetrics::Clock::time_point lockStart = RestMetrics::Clock::now();
+            // Lower priority requests leave part of bucket to higher ones.
+            ratelimitLock.down(bucket.to_string(), unsigned(priority));
+            if (metrics) metrics->recordRatelimitWait(metricsRoute, metricsBucket, RestMetrics::Clock::now() - lockStart);
 #endif
 
-        REST::HTTPResponse response;
-        try {
-            DEBUG_MSG(std::string("Sending REST request: ") + method + " " + request.path + " " + payload.dump());
-            response = restConnection->request(request);
-        } catch (boost::system::system_error& excp) {
-            if (excp.code() != boost::beast::http::error::end_of_stream &&
-                excp.code() != boost::asio::error::broken_pipe &&
-                excp.code() != boost::asio::error::connection_reset) throw;
-
-            DEBUG_MSG("HTTP Connection closed by remote. Reopenning and retrying.");
+            enum { Done, StaleConnection, ConnectFailed } outcome = Done;
             {
-                REST::HeadersMap prevHeaders = std::move(restConnection->connectionHeaders);
-                restConnection.reset(new REST::HTTPSConnection(ioService, "discordapp.com"));
-                restConnection->connectionHeaders = std::move(prevHeaders);
-                restConnection->open();
+                RestMetrics::Clock::time_point queueStart = RestMetrics::Clock::now();
+
+                // Higher priority requests get connection first if all are busy.
+                RequestScheduler::Turn turn(*scheduler, unsigned(priority));
+                std::shared_ptr<REST::HTTPSConnection>& connection = connections[turn.slot];
+
+                RestMetrics::Clock::time_point requestStart = RestMetrics::Clock::now();
+                // Connection errors are recorded as attempts without status.
+                auto recordAttempt = [&](unsigned statusCode, uint64_t bytesReceived) {
+                    if (!metrics) return;
+                    metrics->recordAttempt(metricsRoute, statusCode, requestStart - queueStart,
+                                           RestMetrics::Clock::now() - requestStart,
+                                           bytesSent, bytesReceived);
+                };
+
+                try {
+                    if (!connection->isOpen()) connection->open();
+                } catch (boost::system::system_error& excp) {
+                    DEBUG_MSG(std::string("Failed to connect: ") + excp.what());
+                    recordAttempt(0, 0);
+                    if (failed(attempt)) throw;
+                    connection.reset(new REST::HTTPSConnection(ioService, serverName, port, tls));
+                    outcome = ConnectFailed;
+                }
+
+                if (outcome == Done) {
+                    try {
+                        DEBUG_MSG(std::string("Sending REST request: ") + method + " " + request.path + " " + payload.dump());
+                        response = connection->request(request);
+                        recordAttempt(response.statusCode, response.body().size());
+                    } catch (boost::system::system_error& excp) {
+                        recordAttempt(0, 0);
+                        // Stream is left in the middle of request, whatever happens next.
+                        const bool writtenBefore = connection->requestWritten();
+                        connection.reset(new REST::HTTPSConnection(ioService, serverName, port, tls));
+
+                        if (excp.code() != boost::beast::http::error::end_of_stream &&
+                            excp.code() != boost::asio::error::broken_pipe &&
+                            excp.code() != boost::asio::error::connection_reset) {
+
+                            failed(attempt);
+                            throw;
+                        }
+                        if (attempt >= retryPolicy.maxAttempts) {
+                            failed(attempt);
+                            throw;
+                        }
+                        if (!idempotent && writtenBefore) {
+                            // Connection was lost after request was sent, it may
+                            // be processed already (message posted twice otherwise).
+                            DEBUG_MSG("HTTP Connection lost after sending non-idempotent request, not retrying.");
+                            failed(attempt);
+                            throw;
+                        }
+
+                        // Server closed keep-alive connection before request was
+                        // sent, so it wasn't processed.
+                        DEBUG_MSG("HTTP Connection closed by remote. Reopenning and retrying.");
+                        outcome = StaleConnection;
+                    } catch (...) {
+                        // Body reader or decompression failed, same as above.
+                        // Circuit breaker failure is recorded by outcomeGuard.
+                        recordAttempt(0, 0);
+                        connection.reset(new REST::HTTPSConnection(ioService, serverName, port, tls));
+                        throw;
+                    }
+                }
+            }
+            // Waiting and retrying is done after turn is released, so we
+            // don't hold connection slot meanwhile.
+            if (outcome == StaleConnection) continue;
+            if (outcome == ConnectFailed) {
+                sleepBeforeRetry(attempt);
+                continue;
             }
-            
-            return sendRestRequest(method, endpoint, payload, query, multipart);
-        }
 
-        if (response.body.empty()) {
-            return {};
+            if (response.statusCode / 100 == 5) {
+                if (!failed(attempt) && idempotent) {
+                    DEBUG_MSG(std::string("Got HTTP ") + std::to_string(response.statusCode) + ", retrying.");
+                    sleepBeforeRetry(attempt);
+                    continue;
+                }
+            } else if (circuitBreaker) {
+                outcomeGuard.pending = false;
+                circuitBreaker->recordSuccess(circuitRoute);
+            }
+
+            if (response.statusCode == 429) {
+                if (metrics) metrics->recordRatelimitHit(metricsRoute, metricsBucket);
+#ifdef HEXICORD_RATELIMIT_HIT_AS_ERROR
+                throw RatelimitHit(bucket.to_string());
+#else
+                if (attempt < retryPolicy.maxAttempts) {
+                    // retry_after is in milliseconds.
+                    nlohmann::json ratelimitInfo = nlohmann::json::parse(response.body(), nullptr, false);
+                    unsigned retryAfter = 1000;
+                    if (ratelimitInfo.is_object() && ratelimitInfo["retry_after"].is_number()) {
+                        retryAfter = ratelimitInfo["retry_after"].get<unsigned>();
+                    }
+                    DEBUG_MSG(std::string("Ratelimit hit, retrying after ") + std::to_string(retryAfter) + " ms.");
+                    std::this_thread::sleep_for(std::chrono::milliseconds(retryAfter));
+                    if (metrics) metrics->recordRatelimitWait(metricsRoute, metricsBucket, std::chrono::milliseconds(retryAfter));
+                    continue;
+                }
+#endif
+            }
+            break;
         }
 
-        nlohmann::json jsonResp = nlohmann::json::parse(response.body);
+        // Anything cached for this endpoint is probably outdated now.
+        if (responseCache && method != "GET") responseCache->invalidate(endpoint.to_string());
 
 #ifdef HEXICORD_RATELIMIT_PREDICTION
-        updateRatelimitsIfPresent(endpoint, { response.headers.begin(), response.headers.end() });
+        updateRatelimitsIfPresent(bucket, response);
 #endif
 
         if (response.statusCode / 100 != 2) {
-            if (response.statusCode == 429) {
-#ifdef HEXICORD_RATELIMIT_HIT_AS_ERROR
-                throw RatelimitHit(Utils::getRatelimitDomain(endpoint));
-#else 
-                std::this_thread::sleep_for(std::chrono::seconds(jsonResp["retry_after"].get<unsigned>()));
-                return sendRestRequest(method, endpoint, payload, query);
-#endif 
-            }
+            // Error responses from proxies are not always JSON.
+            nlohmann::json jsonResp = nlohmann::json::parse(response.body(), nullptr, false);
 
             DEBUG_MSG("Got non-2xx HTTP status code.");
             DEBUG_MSG(jsonResp.dump(4));
-            throwRestError(response, jsonResp);
+            if (responseCache && !cacheKey.empty() && response.statusCode == 404) {
+                responseCache->store(cacheKey, jsonResp, response.body().size(), /* negative: */ true);
+            }
+            throwRestError(response.statusCode, jsonResp);
         }
 
-        return jsonResp;
+        return response;
     }
 
     nlohmann::json RestClient::getChannel(Snowflake channelId) {
-        return sendRestRequest("GET", std::string("/channels/") + std::to_string(channelId));
+        return sendRestRequest("GET", Route::make<Routes::Channel>(channelId));
     }
 
     nlohmann::json RestClient::modifyChannel(Snowflake channelId,
@@ -176,11 +453,11 @@ namespace Hexicord {
             throw InvalidParameter("", "No arguments passed to modifyChannel.");
         }
 
-        return sendRestRequest("POST", std::string("/channels/") + std::to_string(channelId), payload);
+        return sendRestRequest("POST", Route::make<Routes::Channel>(channelId), payload);
     }
 
     nlohmann::json RestClient::deleteChannel(Snowflake channelId) {
-        return sendRestRequest("DELETE", std::string("/channels/") + std::to_string(channelId));
+        return sendRestRequest("DELETE", Route::make<Routes::Channel>(channelId));
     }
 
     nlohmann::json RestClient::getMessages(Snowflake channelId, RestClient::After afterId, unsigned limit) {
@@ -188,7 +465,7 @@ namespace Hexicord {
             throw InvalidParameter("limit", "limit out of range (should be 1-100).");
         }
 
-        return sendRestRequest("GET", std::string("/channels/") + std::to_string(channelId) + "/messages",
+        return sendRestRequest("GET", Route::make<Routes::ChannelMessages>(channelId),
                                {}, {{ "after", std::to_string(afterId.id) },
                                     { "limit", std::to_string(limit) }});
     }
@@ -198,9 +475,12 @@ namespace Hexicord {
             throw InvalidParameter("limit", "limit out of range (should be 1-100).");
         }
 
-        return sendRestRequest("GET", std::string("/channels/") + std::to_string(channelId) + "/messages",
-                               {}, {{ "before", std::to_string(beforeId.id) },
-                                    { "limit", std::to_string(limit) }});
+        std::unordered_map<std::string, std::string> query {{ "limit", std::to_string(limit) }};
+        if (beforeId.id != 0) {
+            query.insert({ "before", std::to_string(beforeId.id) });
+        }
+
+        return sendRestRequest("GET", Route::make<Routes::ChannelMessages>(channelId), {}, query);
     }
 
     nlohmann::json RestClient::getMessages(Snowflake channelId, RestClient::Around aroundId, unsigned limit) {
@@ -208,36 +488,31 @@ namespace Hexicord {
             throw InvalidParameter("limit", "limit out of range (should be 2-100).");
         }
 
-        return sendRestRequest("GET", std::string("/channels/") + std::to_string(channelId) + "/messages",
+        return sendRestRequest("GET", Route::make<Routes::ChannelMessages>(channelId),
                                {}, {{ "around", std::to_string(aroundId.id) },
                                     { "limit", std::to_string(limit) }});
     }
 
     nlohmann::json RestClient::getMessage(Snowflake channelId, Snowflake messageId) {
-        return sendRestRequest("GET", std::string("/channels/") + std::to_string(channelId) + 
-                               "/messsages/" + std::to_string(messageId));
+        return sendRestRequest("GET", Route::make<Routes::ChannelMessage>(channelId, messageId));
     }
 
     nlohmann::json RestClient::getPinnedMessages(Snowflake channelId) {
-        return sendRestRequest("GET", std::string("/channels/") + std::to_string(channelId) +
-                                                  "/pins");
+        return sendRestRequest("GET", Route::make<Routes::ChannelPins>(channelId));
     }
 
     void RestClient::pinMessage(Snowflake channelId, Snowflake messageId) {
-        sendRestRequest("PUT", std::string("/channels/") + std::to_string(channelId) +
-                                           "/pins/"      + std::to_string(messageId));
+        sendRestRequest("PUT", Route::make<Routes::ChannelPin>(channelId, messageId));
     }
 
     void RestClient::unpinMessage(Snowflake channelId, Snowflake messageId) {
-        sendRestRequest("DELETE", std::string("/channels/") + std::to_string(channelId) +
-                                              "/pins/"      + std::to_string(messageId));
+        sendRestRequest("DELETE", Route::make<Routes::ChannelPin>(channelId, messageId));
     }
 
     void RestClient::editChannelRolePermissions(Snowflake channelId, Snowflake roleId,
                                     Permissions allow, Permissions deny) {
 
-        sendRestRequest("PUT", std::string("/channels/")   + std::to_string(channelId) +
-                                           "/permissions/" + std::to_string(roleId),
+        sendRestRequest("PUT", Route::make<Routes::ChannelPermission>(channelId, roleId),
             {
                 { "allow", int(allow) },
                 { "deny",  int(deny)  },
@@ -248,8 +523,7 @@ namespace Hexicord {
     void RestClient::editChannelUserPermissions(Snowflake channelId, Snowflake userId,
                                     Permissions allow, Permissions deny) {
 
-        sendRestRequest("PUT", std::string("/channels/")   + std::to_string(channelId) +
-                                           "/permissions/" + std::to_string(userId),
+        sendRestRequest("PUT", Route::make<Routes::ChannelPermission>(channelId, userId),
             {
                 { "allow", int(allow) },
                 { "deny",  int(deny)  },
@@ -258,20 +532,17 @@ namespace Hexicord {
     }
 
     void RestClient::deleteChannelPermissions(Snowflake channelId, Snowflake overrideId) {
-        sendRestRequest("DELETE", std::string("/channels/")   + std::to_string(channelId) +
-                                              "/permissions/" + std::to_string(overrideId));
+        sendRestRequest("DELETE", Route::make<Routes::ChannelPermission>(channelId, overrideId));
     }
 
     void RestClient::kickFromGroupDm(Snowflake groupDmId, Snowflake userId) {
-        sendRestRequest("DELETE", std::string("/channels/")  + std::to_string(groupDmId) +
-                                              "/recipients/" + std::to_string(userId));
+        sendRestRequest("DELETE", Route::make<Routes::ChannelRecipient>(groupDmId, userId));
     }
 
     void RestClient::addToGroupDm(Snowflake groupDmId, Snowflake userId,
                               const std::string& accessToken, const std::string& nick) {
 
-        sendRestRequest("PUT", std::string("/channels/")  + std::to_string(groupDmId) +
-                                           "/recipients/" + std::to_string(userId),
+        sendRestRequest("PUT", Route::make<Routes::ChannelRecipient>(groupDmId, userId),
                         {
                             { "access_token", accessToken },
                             { "nick",         nick        }
@@ -279,14 +550,14 @@ namespace Hexicord {
     }
 
     void RestClient::triggerTypingIndicator(Snowflake channelId) {
-        sendRestRequest("POST", std::string("/channels/") + std::to_string(channelId) + "/typing");
+        sendRestRequest("POST", Route::make<Routes::ChannelTyping>(channelId));
     }
 
     nlohmann::json RestClient::sendTextMessage(Snowflake channelId, const std::string& text,
                                                const nlohmann::json& embed, bool tts) {
         if (text.size() > 2000) throw InvalidParameter("text", "text out of range (should be 0-2000).");
 
-        return sendRestRequest("POST", std::string("/channels/") + std::to_string(channelId) + "/messages",
+        return sendRestRequest("POST", Route::make<Routes::ChannelMessages>(channelId),
                 {
                   { "content", text  },
                   { "tts",     tts   },
@@ -295,7 +566,7 @@ namespace Hexicord {
     }
 
     nlohmann::json RestClient::sendFile(Snowflake channelId, const File& file) {
-        return sendRestRequest("POST", std::string("/channels/") + std::to_string(channelId) + "/messages",
+        return sendRestRequest("POST", Route::make<Routes::ChannelMessages>(channelId),
                                {}, {}, { fileToMultipartEntity(file) });
     }
 
@@ -304,160 +575,139 @@ namespace Hexicord {
         if (text.size() > 2000) {
             throw InvalidParameter("text", "text size out of range (should be 0-1024)");
         }
-        return sendRestRequest("PATCH", std::string("/channels/") + std::to_string(channelId) +
-                               "/messages/" + std::to_string(messageId),
+        return sendRestRequest("PATCH", Route::make<Routes::ChannelMessage>(channelId, messageId),
                                {{ "content", text }, { "embed", embed }});
     }
 
     void RestClient::deleteMessage(Snowflake channelId, Snowflake messageId) {
-        sendRestRequest("DELETE", std::string("/channels/") + std::to_string(channelId) + "/messages/" +
-                        std::to_string(messageId));
+        sendRestRequest("DELETE", Route::make<Routes::ChannelMessage>(channelId, messageId));
     }
 
     void RestClient::deleteMessages(Snowflake channelId, const std::vector<Snowflake>& messageIds) {
-        sendRestRequest("DELETE", std::string("/channels/") + std::to_string(channelId) + "/messages/bulk-delete",
+        sendRestRequest("POST", Route::make<Routes::ChannelBulkDelete>(channelId),
                         {{ "messages", messageIds }});
     }
 
     void RestClient::addReaction(Snowflake channelId, Snowflake messageId, Snowflake emojiId) {
-        sendRestRequest("PUT", std::string("/channels/") + std::to_string(channelId) +
-                                           "/messages/"  + std::to_string(messageId) +
-                                           "/reactions/" + std::to_string(emojiId)   +
-                                           "/@me");
+        sendRestRequest("PUT", Route::make<Routes::MessageOwnReaction>(channelId, messageId, emojiId));
     }
 
     void RestClient::removeReaction(Snowflake channelId, Snowflake messageId, Snowflake emojiId, Snowflake userId) {
-        sendRestRequest("DELETE", std::string("/channels/") + std::to_string(channelId) +
-                                              "/messages/"  + std::to_string(messageId) +
-                                              "/reactions/" + std::to_string(emojiId)   +
-                                             (userId ? std::to_string(userId) : std::string("/@me")));
+        if (userId) {
+            sendRestRequest("DELETE", Route::make<Routes::MessageUserReaction>(channelId, messageId, emojiId, userId));
+        } else {
+            sendRestRequest("DELETE", Route::make<Routes::MessageOwnReaction>(channelId, messageId, emojiId));
+        }
     }
 
     nlohmann::json RestClient::getReactions(Snowflake channelId, Snowflake messageId, Snowflake emojiId) {
-        return sendRestRequest("GET", std::string("/channels/") + std::to_string(channelId) +
-                                                  "/messages/"  + std::to_string(messageId) +
-                                                  "/reactions/" + std::to_string(emojiId));
+        return sendRestRequest("GET", Route::make<Routes::MessageReaction>(channelId, messageId, emojiId));
     }
 
     void RestClient::resetReactions(Snowflake channelId, Snowflake messageId) {
-        sendRestRequest("DELETE", std::string("/channels/") + std::to_string(channelId) +
-                                              "/messages/"  + std::to_string(messageId) +
-                                              "/reactions");
+        sendRestRequest("DELETE", Route::make<Routes::MessageReactions>(channelId, messageId));
     }
 
     nlohmann::json RestClient::getGuild(Snowflake id) {
-        return sendRestRequest("GET", std::string("/guilds/") + std::to_string(id));
+        return sendRestRequest("GET", Route::make<Routes::Guild>(id));
     }
 
     nlohmann::json RestClient::createGuild(const nlohmann::json& newGuildObject) {
-        return sendRestRequest("POST", "/guilds", newGuildObject);
+        return sendRestRequest("POST", Route::make<Routes::Guilds>(), newGuildObject);
     }
 
     nlohmann::json RestClient::modifyGuild(Snowflake id, const nlohmann::json& changedFields) {
-        return sendRestRequest("PATCH", std::string("/guilds/") + std::to_string(id), changedFields);
+        return sendRestRequest("PATCH", Route::make<Routes::Guild>(id), changedFields);
     }
 
     nlohmann::json RestClient::getBans(Snowflake guildId) {
-        return sendRestRequest("GET", std::string("/guilds/") + std::to_string(guildId) +
-                                                  "/bans");
+        return sendRestRequest("GET", Route::make<Routes::GuildBans>(guildId));
     }
 
     void RestClient::banMember(Snowflake guildId, Snowflake userId, unsigned deleteMessagesDays) {
-        sendRestRequest("PUT", std::string("/guilds/") + std::to_string(guildId) +
-                                           "/bans"     + std::to_string(userId),
+        sendRestRequest("PUT", Route::make<Routes::GuildBan>(guildId, userId),
                         {}, {{ "delete-message-days", std::to_string(deleteMessagesDays) }});
+        invalidateCached(std::string("/guilds/") + std::to_string(guildId) + "/bans");
     }
 
     void RestClient::unbanMember(Snowflake guildId, Snowflake userId) {
-        sendRestRequest("DELETE", std::string("/guilds/") + std::to_string(guildId) +
-                                              "/bans"     + std::to_string(userId));
+        sendRestRequest("DELETE", Route::make<Routes::GuildBan>(guildId, userId));
+        invalidateCached(std::string("/guilds/") + std::to_string(guildId) + "/bans");
     }
 
     void RestClient::kickMember(Snowflake guildId, Snowflake userId) {
-        sendRestRequest("DELETE", std::string("/guilds/") + std::to_string(guildId) +
-                                              "/members"  + std::to_string(userId));
+        sendRestRequest("DELETE", Route::make<Routes::GuildMember>(guildId, userId));
     }
 
     nlohmann::json RestClient::getChannels(Snowflake guildId) {
-        return sendRestRequest("GET", std::string("/guilds/") + std::to_string(guildId) +
-                                                  "/channels");
+        return sendRestRequest("GET", Route::make<Routes::GuildChannels>(guildId));
     }
 
     nlohmann::json RestClient::getMembers(Snowflake guildId, unsigned limit, Snowflake after) {
-        return sendRestRequest(std::string("/guilds/") + std::to_string(guildId) + "/members", {},
+        if (limit > 1000 || limit == 0) {
+            throw InvalidParameter("limit", "limit out of range (should be 1-1000).");
+        }
+
+        return sendRestRequest("GET", Route::make<Routes::GuildMembers>(guildId),
                                {}, {{ "limit", std::to_string(limit) }, { "after", std::to_string(after) }});
     }
 
     nlohmann::json RestClient::getMember(Snowflake guildId, Snowflake userId) {
-        return sendRestRequest("GET", std::string("/guilds/") +  std::to_string(guildId) +
-                                                  "/members/" +  std::to_string(userId));
+        return sendRestRequest("GET", Route::make<Routes::GuildMember>(guildId, userId));
     }
 
     void RestClient::setMemberNickname(Snowflake guildId, Snowflake userId, const std::string& newNick) {
-        sendRestRequest("PATCH", std::string("/guilds")  + std::to_string(guildId) +
-                                             "/members/" + std::to_string(userId),
+        sendRestRequest("PATCH", Route::make<Routes::GuildMember>(guildId, userId),
                         {{ "nick", newNick }});
     }
 
     void RestClient::setMemberRoles(Snowflake guildId, Snowflake userId, const std::vector<Snowflake>& newRoles) {
-        sendRestRequest("PATCH", std::string("/guilds")  + std::to_string(guildId) +
-                                             "/members/" + std::to_string(userId),
+        sendRestRequest("PATCH", Route::make<Routes::GuildMember>(guildId, userId),
                         {{ "roles", newRoles }});
     }
 
     void RestClient::setMemberMute(Snowflake guildId, Snowflake userId, bool muted) {
-        sendRestRequest("PATCH", std::string("/guilds")  + std::to_string(guildId) +
-                                             "/members/" + std::to_string(userId),
+        sendRestRequest("PATCH", Route::make<Routes::GuildMember>(guildId, userId),
                         {{ "mute", muted }});
     }
 
     void RestClient::setMemberDeaf(Snowflake guildId, Snowflake userId, bool deafen) {
-        sendRestRequest("PATCH", std::string("/guilds")  + std::to_string(guildId) +
-                                             "/members/" + std::to_string(userId),
+        sendRestRequest("PATCH", Route::make<Routes::GuildMember>(guildId, userId),
                         {{ "deaf", deafen }});
     }
 
     void RestClient::moveMember(Snowflake guildId, Snowflake userId, Snowflake targetChannel) {
-        sendRestRequest("PATCH", std::string("/guilds")  + std::to_string(guildId) +
-                                             "/members/" + std::to_string(userId),
+        sendRestRequest("PATCH", Route::make<Routes::GuildMember>(guildId, userId),
                         {{ "channel_id", targetChannel }});
     }
 
     nlohmann::json RestClient::getGuildIntegrations(Snowflake guildId) {
-        return sendRestRequest("GET", std::string("/guilds/") + std::to_string(guildId) +
-                                                  "/integrations");
+        return sendRestRequest("GET", Route::make<Routes::GuildIntegrations>(guildId));
     }
 
     void RestClient::attachIntegration(Snowflake guildId, const std::string& type, Snowflake integrationId) {
-        sendRestRequest("POST", std::string("/guilds/") + std::to_string(guildId) +
-                                            "/integrations",
+        sendRestRequest("POST", Route::make<Routes::GuildIntegrations>(guildId),
                         {{ "type", type }, { "id", integrationId }});
     }
 
     void RestClient::detachIntegration(Snowflake guildId, Snowflake integrationId) {
-        sendRestRequest("DELETE", std::string("/guilds/")      + std::to_string(guildId) +
-                                              "/integrations/" + std::to_string(integrationId));
+        sendRestRequest("DELETE", Route::make<Routes::GuildIntegration>(guildId, integrationId));
     }
 
     void RestClient::syncIntegration(Snowflake guildId, Snowflake integrationId) {
-        sendRestRequest("POST", std::string("/guilds/")      + std::to_string(guildId) +
-                                            "/integrations/" + std::to_string(integrationId) +
-                                            "/sync");
+        sendRestRequest("POST", Route::make<Routes::GuildIntegrationSync>(guildId, integrationId));
     }
 
     nlohmann::json RestClient::getGuildEmbed(Snowflake guildId) {
-        return sendRestRequest("GET", std::string("/guilds/") + std::to_string(guildId) +
-                                                  "/embed");
+        return sendRestRequest("GET", Route::make<Routes::GuildEmbed>(guildId));
     }
 
     void RestClient::modifyGuildEmbed(Snowflake guildId, bool enabled, Snowflake channelId) {
-        sendRestRequest("PATCH", std::string("/guilds/") + std::to_string(guildId) +
-                                             "/embed", {{ "enabled", enabled }, { "channel_id", channelId }});
+        sendRestRequest("PATCH", Route::make<Routes::GuildEmbed>(guildId), {{ "enabled", enabled }, { "channel_id", channelId }});
     }
 
     nlohmann::json RestClient::createChannel(Snowflake guildId, const nlohmann::json& channelFields) {
-        return sendRestRequest("POST", std::string("/guilds/") + std::to_string(guildId) +
-                                                   "/channels", channelFields);
+        return sendRestRequest("POST", Route::make<Routes::GuildChannels>(guildId), channelFields);
     }
 
     void RestClient::reorderChannels(Snowflake guildId, const std::vector<std::pair<Snowflake, unsigned>>& newPositions) {
@@ -465,8 +715,7 @@ namespace Hexicord {
         for (const auto& pair : newPositions) {
             payload.push_back({{ "id", pair.first }, { "position", pair.second }});
         }
-        sendRestRequest("PATCH", std::string("/guilds/") + std::to_string(guildId) +
-                                             "/channels");
+        sendRestRequest("PATCH", Route::make<Routes::GuildChannels>(guildId), payload);
     }
 
     void RestClient::reorderRoles(Snowflake guildId, const std::vector<std::pair<Snowflake, unsigned>>& newPositions) {
@@ -474,60 +723,51 @@ namespace Hexicord {
         for (const auto& pair : newPositions) {
             payload.push_back({{ "id", pair.first }, { "position", pair.second }});
         }
-        sendRestRequest("PATCH", std::string("/guilds/") + std::to_string(guildId) +
-                                             "/roles");
+        sendRestRequest("PATCH", Route::make<Routes::GuildRoles>(guildId), payload);
     }
 
     nlohmann::json RestClient::getRoles(Snowflake guildId) {
-        return sendRestRequest("GET", std::string("/guilds/") + std::to_string(guildId) +
-                                                  "/roles");
+        return sendRestRequest("GET", Route::make<Routes::GuildRoles>(guildId));
     }
 
     nlohmann::json RestClient::createRole(Snowflake guildId, const nlohmann::json& roleObject) {
-        return sendRestRequest("GET", std::string("/guilds/") + std::to_string(guildId) +
-                                                  "/roles", roleObject);
+        return sendRestRequest("POST", Route::make<Routes::GuildRoles>(guildId), roleObject);
     }
 
     nlohmann::json RestClient::modifyRole(Snowflake guildId, Snowflake roleId,
                                           const nlohmann::json& updatedFields) {
-        return sendRestRequest("PATCH", std::string("/guilds/") + std::to_string(guildId) +
-                                                    "/roles"    + std::to_string(roleId),
+        return sendRestRequest("PATCH", Route::make<Routes::GuildRole>(guildId, roleId),
                                updatedFields);
     }
 
     void RestClient::deleteRole(Snowflake guildId, Snowflake roleId) {
-        sendRestRequest("DELETE", std::string("/guilds/") + std::to_string(guildId) +
-                                              "/roles"    + std::to_string(roleId));
+        sendRestRequest("DELETE", Route::make<Routes::GuildRole>(guildId, roleId));
     }
 
     void RestClient::giveRole(Snowflake guildId, Snowflake userId, Snowflake roleId) {
-        sendRestRequest("PUT", std::string("/guilds/") + std::to_string(guildId) +
-                                           "/members/" + std::to_string(userId) +
-                                           "/roles/"   + std::to_string(roleId));
+        sendRestRequest("PUT", Route::make<Routes::GuildMemberRole>(guildId, userId, roleId));
+        invalidateCached(std::string("/guilds/") + std::to_string(guildId) + "/members/" + std::to_string(userId));
     }
 
     void RestClient::takeRole(Snowflake guildId, Snowflake userId, Snowflake roleId) {
-        sendRestRequest("DELETE", std::string("/guilds/") + std::to_string(guildId) +
-                                              "/members/" + std::to_string(userId) +
-                                              "/roles/"   + std::to_string(roleId));
+        sendRestRequest("DELETE", Route::make<Routes::GuildMemberRole>(guildId, userId, roleId));
+        invalidateCached(std::string("/guilds/") + std::to_string(guildId) + "/members/" + std::to_string(userId));
     }
 
     unsigned RestClient::getGuildPruneCount(Snowflake guildId, unsigned days) {
-        return sendRestRequest("GET", std::string("/guilds/") + std::to_string(guildId) +
-                                                  "/prune", {}, {{ "days", std::to_string(days) }})["pruned"];
+        return sendRestRequest("GET", Route::make<Routes::GuildPrune>(guildId), {}, {{ "days", std::to_string(days) }})["pruned"];
     }
 
     unsigned RestClient::beginGuildPrune(Snowflake guildId, unsigned days) {
-        return sendRestRequest("POST", std::string("/guilds/") + std::to_string(guildId) +
-                                                   "/prune", {}, {{ "days", std::to_string(days) }})["pruned"];
+        return sendRestRequest("POST", Route::make<Routes::GuildPrune>(guildId), {}, {{ "days", std::to_string(days) }})["pruned"];
     }
 
     nlohmann::json RestClient::getMe() {
-        return sendRestRequest("GET", std::string("/users/@me"));
+        return sendRestRequest("GET", Route::make<Routes::Me>());
     }
 
     nlohmann::json RestClient::getUser(Snowflake id) {
-        return sendRestRequest("GET", std::string("/users/") + std::to_string(id));
+        return sendRestRequest("GET", Route::make<Routes::User>(id));
     }
 
     nlohmann::json RestClient::setUsername(const std::string& newUsername) {
@@ -552,11 +792,11 @@ namespace Hexicord {
             }
         }
 
-        return sendRestRequest("PATCH", "/users/@me", {{ "username", newUsername }});
+        return sendRestRequest("PATCH", Route::make<Routes::Me>(), {{ "username", newUsername }});
     }
 
     nlohmann::json RestClient::setAvatar(const Image& avatar) {
-        return sendRestRequest("PATCH", "/users/@me", {{ "avatar", avatar.toAvatarData() }});
+        return sendRestRequest("PATCH", Route::make<Routes::Me>(), {{ "avatar", avatar.toAvatarData() }});
     }
 
     nlohmann::json RestClient::getUserGuilds(uint16_t limit, Snowflake startId, bool before) {
@@ -567,53 +807,54 @@ namespace Hexicord {
         if (startId != 0) {
             query.insert({ before ? "before" : "after", std::to_string(startId) });
         }
-        return sendRestRequest("GET", "/users/@me/guilds", {}, query);
+        return sendRestRequest("GET", Route::make<Routes::MyGuilds>(), {}, query);
     }
 
     void RestClient::leaveGuild(Snowflake guildId) {
-        sendRestRequest("DELETE", std::string("/users/@me/guilds/") + std::to_string(guildId));
+        sendRestRequest("DELETE", Route::make<Routes::MyGuild>(guildId));
     }
 
     nlohmann::json RestClient::getUserDms() {
-        return sendRestRequest("GET", "/users/@me/channels");
+        return sendRestRequest("GET", Route::make<Routes::MyChannels>());
     }
 
     nlohmann::json RestClient::createDm(Snowflake recipientId) {
-        return sendRestRequest("POST", "/users/@me/channels", {{ "recipient_id", recipientId }});
+        return sendRestRequest("POST", Route::make<Routes::MyChannels>(), {{ "recipient_id", recipientId }});
     }
 
 
     nlohmann::json RestClient::createGroupDm(const std::vector<Snowflake>& accessTokens,
                                          const std::unordered_map<Snowflake, std::string>& nicks) {
 
-        return sendRestRequest("POST", "/users/@me/channels", {{ "access_tokens", accessTokens },
+        return sendRestRequest("POST", Route::make<Routes::MyChannels>(), {{ "access_tokens", accessTokens },
                                                                { "nicks",         nicks        }});
     }
 
     nlohmann::json RestClient::getConnections() {
-        return sendRestRequest("GET", "/users/@me/connections");
+        return sendRestRequest("GET", Route::make<Routes::MyConnections>());
     }
 
     nlohmann::json RestClient::getInvites(Snowflake guildId) {
-        return sendRestRequest("GET", std::string("/guilds/") + std::to_string(guildId) +
-                                                  "/invites");
+        return sendRestRequest("GET", Route::make<Routes::GuildInvites>(guildId));
     }
 
     nlohmann::json RestClient::getInvite(const std::string& inviteCode) {
-        return sendRestRequest("GET", std::string("/invites/") + inviteCode);
+        return sendRestRequest("GET", Route::make<Routes::Invite>(inviteCode));
     }
 
     nlohmann::json RestClient::revokeInvite(const std::string& inviteCode) {
-        return sendRestRequest("DELETE", std::string("/invites/") + inviteCode);
+        nlohmann::json result = sendRestRequest("DELETE", Route::make<Routes::Invite>(inviteCode));
+        invalidateCached("/channels/{channel}/invites");
+        invalidateCached("/guilds/{guild}/invites");
+        return result;
     }
 
     nlohmann::json RestClient::acceptInvite(const std::string& inviteCode) {
-        return sendRestRequest("POST", std::string("/invites/") + inviteCode);
+        return sendRestRequest("POST", Route::make<Routes::Invite>(inviteCode));
     }
 
     nlohmann::json RestClient::getChannelInvites(Snowflake channelId) {
-        return sendRestRequest("GET", std::string("/channels/") + std::to_string(channelId) +
-                                                  "/invites");
+        return sendRestRequest("GET", Route::make<Routes::ChannelInvites>(channelId));
     }
 
     nlohmann::json RestClient::createInvite(Snowflake channelId, unsigned maxAgeSecs,
@@ -626,21 +867,22 @@ namespace Hexicord {
         if (temporaryMembership)  payload["temporary_membership"] = true;
         if (unique)               payload["unique"]               = true;
 
-        return sendRestRequest("DELETE", std::string("/channels") + std::to_string(channelId), payload);
+        nlohmann::json result = sendRestRequest("POST", Route::make<Routes::ChannelInvites>(channelId), payload);
+        invalidateCached(std::string("/channels/") + std::to_string(channelId) + "/invites");
+        invalidateCached("/guilds/{guild}/invites");
+        return result;
     }
 
     nlohmann::json RestClient::getWebhook(Snowflake id) {
-        return sendRestRequest("GET", std::string("/webhooks/") + std::to_string(id));
+        return sendRestRequest("GET", Route::make<Routes::Webhook>(id));
     }
 
     nlohmann::json RestClient::getChannelWebhooks(Snowflake channelId) {
-        return sendRestRequest("GET", std::string("/channels/") + std::to_string(channelId) +
-                                                  "/webhooks");
+        return sendRestRequest("GET", Route::make<Routes::ChannelWebhooks>(channelId));
     }
 
     nlohmann::json RestClient::getGuildWebhooks(Snowflake guildId) {
-        return sendRestRequest("GET", std::string("/guilds/") + std::to_string(guildId) +
-                                                  "/webhooks");
+        return sendRestRequest("GET", Route::make<Routes::GuildWebhooks>(guildId));
     }
 
     nlohmann::json RestClient::createWebhook(Snowflake channelId, const std::string& name, const boost::optional<Image>& avatar) {
@@ -652,24 +894,68 @@ namespace Hexicord {
         if (avatar) {
             payload["avatar"] = avatar->toAvatarData();
         }
-        return sendRestRequest("POST", std::string("/channels/") + std::to_string(channelId) + "/webhooks",
-                               payload);
+        nlohmann::json result = sendRestRequest("POST", Route::make<Routes::ChannelWebhooks>(channelId),
+                                                payload);
+        invalidateCached(std::string("/channels/") + std::to_string(channelId) + "/webhooks");
+        invalidateCached("/guilds/{guild}/webhooks");
+        return result;
     }
 
     nlohmann::json RestClient::setWebhookName(Snowflake id, const std::string& newName) {
         if (newName.size() == 1 || newName.size() > 32) {
             throw InvalidParameter("name", "size out of range (should be 2-32)");
         }
-        return sendRestRequest("PATCH", std::string("/webhooks/") + std::to_string(id), {{ "name", newName }});
+        nlohmann::json result = sendRestRequest("PATCH", Route::make<Routes::Webhook>(id), {{ "name", newName }});
+        invalidateCached("/channels/{channel}/webhooks");
+        invalidateCached("/guilds/{guild}/webhooks");
+        return result;
     }
 
     nlohmann::json RestClient::setWebhookAvatar(Snowflake id, const Image& newAvatar) {
-        return sendRestRequest("PATCH", std::string("/webhooks/") + std::to_string(id),
-                               {{ "avatar", newAvatar.toAvatarData() }});
+        nlohmann::json result = sendRestRequest("PATCH", Route::make<Routes::Webhook>(id),
+                                                {{ "avatar", newAvatar.toAvatarData() }});
+        invalidateCached("/channels/{channel}/webhooks");
+        invalidateCached("/guilds/{guild}/webhooks");
+        return result;
     }
 
     void RestClient::deleteWebhook(Snowflake id) {
-        sendRestRequest("DELETE", std::string("/webhooks/") + std::to_string(id));
+        sendRestRequest("DELETE", Route::make<Routes::Webhook>(id));
+        invalidateCached("/channels/{channel}/webhooks");
+        invalidateCached("/guilds/{guild}/webhooks");
+    }
+
+    nlohmann::json RestClient::executeWebhook(Snowflake id, const std::string& webhookToken,
+                                              const std::string& text,
+                                              const nlohmann::json& embeds,
+                                              const boost::optional<File>& file,
+                                              const std::string& username,
+                                              const std::string& avatarUrl,
+                                              bool tts, bool wait) {
+
+        if (text.size() > 2000) throw InvalidParameter("text", "text out of range (should be 0-2000).");
+        if (!embeds.is_null() && (!embeds.is_array() || embeds.size() > 10)) {
+            throw InvalidParameter("embeds", "embeds should be array of up to 10 embeds.");
+        }
+        if (text.empty() && embeds.empty() && !file) {
+            throw InvalidParameter("text", "one of text, embeds or file should be present.");
+        }
+
+        nlohmann::json payload;
+        if (!text.empty())      payload["content"]    = text;
+        if (!embeds.is_null())  payload["embeds"]     = embeds;
+        if (!username.empty())  payload["username"]   = username;
+        if (!avatarUrl.empty()) payload["avatar_url"] = avatarUrl;
+        if (tts)                payload["tts"]        = true;
+
+        std::unordered_map<std::string, std::string> query;
+        if (wait) query.insert({ "wait", "true" });
+
+        std::vector<REST::MultipartEntity> multipart;
+        if (file) multipart.push_back(fileToMultipartEntity(*file));
+
+        return sendRestRequest("POST", Route::make<Routes::WebhookWithToken>(id, webhookToken),
+                               payload, query, multipart);
     }
 
     void RestClient::prepareRequestBody(REST::HTTPRequest& request,
@@ -682,36 +968,39 @@ namespace Hexicord {
 
             request.headers.emplace("Content-Type", "application/json");
 
-            std::string jsonStr = payload.dump();
-            std::vector<uint8_t> payloadBytes(jsonStr.begin(), jsonStr.end());
-
-            request.body = payloadBytes;
+            bodyWriter.clear();
+            bodyWriter.append(payload);
+            request.body.emplace_back(reinterpret_cast<const uint8_t*>(bodyWriter.data()), bodyWriter.size());
         } else {
             std::vector<REST::MultipartEntity> actualMultipartElements;
             actualMultipartElements.reserve(elements.size() + 1);
 
             // We add JSON payload as first element.
             if (!payload.is_null() && !payload.empty()) {
-                std::string bodyStr = Utils::urlEncode(payload.dump());
                 actualMultipartElements.push_back({
                         /* name:              */ "payload_json",
                         /* filename:          */ "",
                         /* additionalHeaders: */ {{ "Content-Type", "application/json" }},
-                        /* body               */ std::vector<uint8_t>(bodyStr.begin(), bodyStr.end())
+                        /* body               */ Utils::urlEncode(payload.dump())
                         });
             }
 
+            // Copying entities doesn't copy their bodies.
             for (const auto& element : elements) actualMultipartElements.push_back(element);
 
             REST::HTTPRequest tempRequest = REST::buildMultipartRequest(actualMultipartElements);
             request.headers["Content-Type"] = tempRequest.headers["Content-Type"];
-            request.body                    = tempRequest.body;
+            request.body                    = std::move(tempRequest.body);
         }
     }
 
-    void RestClient::throwRestError(const REST::HTTPResponse& response,
+    void RestClient::throwRestError(unsigned statusCode,
                                 const nlohmann::json& payload) {
 
+            if (!payload.is_object()) {
+                throw RESTError(std::string("HTTP error ") + std::to_string(statusCode), -1, int(statusCode));
+            }
+
             int code = -1;
             if (payload.find("code") != payload.end()) code = payload["code"];
             if (payload.find("message") != payload.end()) {
@@ -722,7 +1011,7 @@ namespace Hexicord {
                     throw LimitReached(payload["message"], code); 
                 }
 
-                throw RESTError(payload["message"].get<std::string>(), code, response.statusCode);
+                throw RESTError(payload["message"].get<std::string>(), code, statusCode);
             }
             
 
@@ -751,20 +1040,28 @@ namespace Hexicord {
             throw RESTError("Unknown error");
     }
 
-#ifdef HEXICORD_RATELIMIT_PREDICTION 
-    void RestClient::updateRatelimitsIfPresent(const std::string& endpoint,
-                                               const std::unordered_map<std::string, std::string>& headers) {
+    void RestClient::invalidateCached(const std::string& pattern) {
+        if (responseCache) responseCache->invalidate(pattern);
+    }
 
-        auto remainingIt = headers.find("X-RateLimit-Remaining");
-        auto limitIt     = headers.find("X-RateLimit-Limit");
-        auto resetIt     = headers.find("X-RateLimit-Reset");
+#ifdef HEXICORD_RATELIMIT_PREDICTION 
+    void RestClient::updateRatelimitsIfPresent(boost::string_view bucket, const REST::HTTPResponse& response) {
+        // Parse header value without copying it into std::string first.
+        auto toNumber = [](boost::string_view value) -> unsigned long long {
+            unsigned long long result = 0;
+            for (char ch : value) {
+                if (ch < '0' || ch > '9') break;
+                result = result * 10 + unsigned(ch - '0');
+            }
+            return result;
+        };
 
-        unsigned remaining  =  remainingIt  !=  headers.end() ? std::stoi(remainingIt->second)  : 0;
-        unsigned limit      =  limitIt      !=  headers.end() ? std::stoi(limitIt->second)      : 0;
-        time_t reset        =  resetIt      !=  headers.end() ? std::stoll(resetIt->second)     : 0;
+        unsigned remaining  = unsigned(toNumber(response.header("X-RateLimit-Remaining")));
+        unsigned limit      = unsigned(toNumber(response.header("X-RateLimit-Limit")));
+        time_t reset        = time_t(toNumber(response.header("X-RateLimit-Reset")));
 
         if (remaining && limit && reset) {
-            ratelimitLock.refreshInfo(Utils::getRatelimitDomain(endpoint), remaining, limit, reset);
+            ratelimitLock.refreshInfo(bucket.to_string(), remaining, limit, reset);
         }
     }
 #endif // HEXICORD_RATELIMIT_PREDICTION
@@ -774,7 +1071,9 @@ namespace Hexicord {
                 /* name:              */ file.filename,
                 /* filename:          */ file.filename,
                 /* additionalHeaders: */ {},
-                /* body:              */ file.bytes
+                // File contents is shared, not copied (it may be memory-mapped).
+                /* body:              */ file.isStreamed() ? REST::BodySegment(file.size(), file.reader)
+                                                           : REST::BodySegment(file.data(), size_t(file.size()), file.storage())
                };
     }
 } // namespace Hexicord
@@ -28,19 +28,64 @@
 #include <vector>                       // std::vector
 #include <unordered_map>                // std::unordered_map
 #include <memory>                       // std::shared_ptr
+#include <future>                       // std::future
 #include <boost/optional.hpp>           // boost::optional
+#include <boost/utility/string_view.hpp> // boost::string_view
 #include "hexicord/json.hpp"            // nlohamnn::json
 #include "hexicord/permission.hpp"      // Hexicord::Permissions
 #include "hexicord/config.hpp"          // HEXICORD_RATELIMIT_PREDICTION
 #include "hexicord/types.hpp"           // Hexicord::Snowflake, Hexicord::File, Hexicord::Image
+#include "hexicord/response_cache.hpp"  // Hexicord::ResponseCache
+#include "hexicord/retry_policy.hpp"    // Hexicord::RetryPolicy, Hexicord::CircuitBreaker
+#include "hexicord/rest_metrics.hpp"    // Hexicord::RestMetrics
 namespace boost { namespace asio { class io_service; }}
 namespace Hexicord { namespace REST { class HTTPSConnection; class MultipartEntity; class HTTPRequest; class HTTPResponse; }}
+namespace Hexicord { class RequestScheduler; class Route; }
 #ifdef HEXICORD_RATELIMIT_PREDICTION
     #include "hexicord/ratelimit_lock.hpp"
 #endif
 
 namespace Hexicord {
 
+    /**
+     * Priority class of REST request.
+     *
+     * When all connections are busy, waiting requests are served in
+     * order of their class. Lower classes still get some turns, so they
+     * are slowed down, but never blocked completely.
+     */
+    enum class RequestPriority : unsigned {
+        Interactive = 0, ///< Replies to users and other latency-sensitive requests.
+        Normal      = 1, ///< Used by default.
+        Background  = 2, ///< Bulk jobs like mass role updates.
+
+        /// Use priority set for current thread by \ref PriorityScope
+        /// (Normal if none).
+        Inherit     = 3
+    };
+
+    /**
+     * Sets default priority of REST requests made from current thread
+     * while exists.
+     *
+     * ```cpp
+     * {
+     *     Hexicord::PriorityScope scope(Hexicord::RequestPriority::Background);
+     *     for (Hexicord::Snowflake member : members) rclient.giveRole(guild, member, role);
+     * }
+     * ```
+     */
+    class PriorityScope {
+    public:
+        explicit PriorityScope(RequestPriority priority);
+        ~PriorityScope();
+
+        PriorityScope(const PriorityScope&) = delete;
+        PriorityScope& operator=(const PriorityScope&) = delete;
+    private:
+        RequestPriority previous;
+    };
+
     class RestClient {
     public:
         /**
@@ -52,8 +97,16 @@ namespace Hexicord {
          * \param token     token string, will be interpreted as OAuth or Bot token
          *                  depending on future calls, don't add "Bearer " or
          *                  "Bot " prefix.
+         * \param connectionsCount Count of persistent connections, requests are
+         *                         performed concurrently if multiple threads
+         *                         use same RestClient.
+         * \param serverName Host to send requests to, change it only to use
+         *                   testing server (like tools/mock-rest-server).
+         * \param port       Server port.
+         * \param tls        Use HTTPS, plain HTTP is used if false.
          */
-        RestClient(boost::asio::io_service& ioService, const std::string& token);
+        RestClient(boost::asio::io_service& ioService, const std::string& token, unsigned connectionsCount = 1,
+                   const std::string& serverName = "discordapp.com", unsigned short port = 443, bool tls = true);
 
         RestClient(const RestClient&) = delete;
         RestClient(RestClient&&) = default;
@@ -61,6 +114,17 @@ namespace Hexicord {
         RestClient& operator=(const RestClient&) = delete;
         RestClient& operator=(RestClient&&) = default;
 
+        /**
+         * Open all connections in background, so first requests don't
+         * wait for TCP and TLS handshakes. Call it before connecting to
+         * gateway to do both things in parallel.
+         *
+         * Returned future rethrows connection error, if any. Keep it
+         * until gateway is connected: like any future from std::async,
+         * it waits for completion when destroyed.
+         */
+        std::future<void> prewarm();
+
         /**
          * Returns gateway URL to be used with \ref GatewayClient::connect.
          *
@@ -97,13 +161,46 @@ namespace Hexicord {
          * \param query     GET request query.
          * \param multipart Pass one or more MultipartEntity to perform multipart request.
          *                  If payload is also present, it will be first entity.
+         * \param priority  Priority class of this request, see \ref RequestPriority.
          *
          * \ingroup REST
          */
         nlohmann::json sendRestRequest(const std::string& method, const std::string& endpoint,
                                        const nlohmann::json& payload = {},
                                        const std::unordered_map<std::string, std::string>& query = {},
-                                       const std::vector<REST::MultipartEntity>& multipart = {});
+                                       const std::vector<REST::MultipartEntity>& multipart = {},
+                                       RequestPriority priority = RequestPriority::Inherit);
+
+        /**
+         * Same as \ref sendRestRequest but returns response body as JSON
+         * text, without parsing it. Response cache is not used.
+         *
+         * \ingroup REST
+         */
+        std::string sendRawRequest(const std::string& method, const std::string& endpoint,
+                                   const nlohmann::json& payload = {},
+                                   const std::unordered_map<std::string, std::string>& query = {},
+                                   const std::vector<REST::MultipartEntity>& multipart = {},
+                                   RequestPriority priority = RequestPriority::Inherit);
+
+        /**
+         * Same as \ref sendRawRequest but decodes response into model from
+         * models.hpp, so no nlohmann::json DOM is built:
+         * ```cpp
+         * Hexicord::Message message = rclient.sendTypedRequest<Hexicord::Message>(
+         *     "GET", "/channels/" + std::to_string(channelId) + "/messages/" + std::to_string(messageId));
+         * ```
+         *
+         * \ingroup REST
+         */
+        template<typename Model>
+        Model sendTypedRequest(const std::string& method, const std::string& endpoint,
+                               const nlohmann::json& payload = {},
+                               const std::unordered_map<std::string, std::string>& query = {},
+                               const std::vector<REST::MultipartEntity>& multipart = {},
+                               RequestPriority priority = RequestPriority::Inherit) {
+            return Model::fromJson(sendRawRequest(method, endpoint, payload, query, multipart, priority));
+        }
 
         /** \defgroup REST REST methods
          *
@@ -201,13 +298,17 @@ namespace Hexicord {
          * Get messages after specified id.
          *
          * Limit can't be larger than 100, default is 50.
+         *
+         * \sa \ref Paginator::messagesAfter
          */
         nlohmann::json getMessages(Snowflake channelId, After afterId, unsigned limit = 50);
 
         /**
-         * Get messages before specified id.
+         * Get messages before specified id, or latest messages if id is 0.
          *
          * Limit can't be larger than 100, default is 50.
+         *
+         * \sa \ref Paginator::messagesBefore
          */
         nlohmann::json getMessages(Snowflake channelId, Before beforeId, unsigned limit = 50);
 
@@ -572,6 +673,8 @@ namespace Hexicord {
          * docs say "the highest user id in the previous page", but we know that returned
          * array is sorted by ids, so basicly it's same as "last user id in the
          * previous page".
+         *
+         * \sa \ref Paginator::members
          */
         nlohmann::json getMembers(Snowflake guildId, unsigned limit = 100, Snowflake after = 0);
 
@@ -959,6 +1062,31 @@ namespace Hexicord {
          */
         void deleteWebhook(Snowflake id);
 
+        /**
+         * Send message using webhook. Doesn't requires any authorization
+         * except webhook token, so RestClient with empty token can be used.
+         *
+         * Each webhook has own ratelimit bucket, see \ref WebhookSender
+         * if you need to send a lot of messages.
+         *
+         * \param text      Message text, up to 2000 characters.
+         * \param embeds    Array of up to 10 embed objects, or null.
+         * \param file      File to attach.
+         * \param username  Override webhook's default username if not empty.
+         * \param avatarUrl Override webhook's default avatar if not empty.
+         * \param wait      Wait for message to be created and return it,
+         *                  otherwise empty object is returned.
+         *
+         * At least one of text, embeds or file should be present.
+         */
+        nlohmann::json executeWebhook(Snowflake id, const std::string& webhookToken,
+                                      const std::string& text,
+                                      const nlohmann::json& embeds = nullptr,
+                                      const boost::optional<File>& file = boost::none,
+                                      const std::string& username = "",
+                                      const std::string& avatarUrl = "",
+                                      bool tts = false, bool wait = true);
+
         /// @} REST_webhooks
 
         /// @} REST
@@ -968,29 +1096,112 @@ namespace Hexicord {
         RatelimitLock ratelimitLock;
 #endif
 
+        /**
+         * Cache for GET requests responses, disabled (nullptr) by default.
+         *
+         * ```cpp
+         * rclient.responseCache.reset(new Hexicord::ResponseCache(8 * 1024 * 1024));
+         * rclient.responseCache->setTtl("/invites/{code}", std::chrono::minutes(5), std::chrono::minutes(1));
+         * rclient.responseCache->setTtl("/users/{user}",   std::chrono::minutes(30));
+         * ```
+         *
+         * Entries are invalidated by mutating requests to same endpoint and by
+         * methods that affect related lists (\ref deleteWebhook, \ref revokeInvite,
+         * \ref unbanMember, etc).
+         */
+        std::shared_ptr<ResponseCache> responseCache;
+
+        /**
+         * How failed requests are retried, see \ref RetryPolicy. Should
+         * not be changed while requests are performed.
+         */
+        RetryPolicy retryPolicy;
+
+        /**
+         * Rejects requests to routes that are failing right now. Set to
+         * nullptr to disable.
+         *
+         * Can be shared between multiple RestClient's.
+         *
+         * ```cpp
+         * rclient.circuitBreaker = std::make_shared<Hexicord::CircuitBreaker>(10, std::chrono::seconds(60));
+         * ```
+         */
+        std::shared_ptr<CircuitBreaker> circuitBreaker;
+
+        /**
+         * Request statistics, not collected (nullptr) by default. See
+         * \ref RestMetrics.
+         */
+        std::shared_ptr<RestMetrics> metrics;
+
         /**
          * Used authorization token.
          */
         const std::string token;
+
+        const std::string serverName;
+        const unsigned short port;
+        const bool tls;
 private:
         static constexpr const char* restBasePath = "/api/v6";
 
+        // Same as public sendRestRequest but with path and ratelimit bucket
+        // key formatted from route pattern, used by all REST methods.
+        nlohmann::json sendRestRequest(const std::string& method, const Route& route,
+                                       const nlohmann::json& payload = {},
+                                       const std::unordered_map<std::string, std::string>& query = {},
+                                       const std::vector<REST::MultipartEntity>& multipart = {},
+                                       RequestPriority priority = RequestPriority::Inherit);
+
+        nlohmann::json performRequest(const std::string& method,
+                                      boost::string_view endpoint,
+                                      boost::string_view bucket,
+                                      boost::string_view routeName,
+                                      const nlohmann::json& payload,
+                                      const std::unordered_map<std::string, std::string>& query,
+                                      const std::vector<REST::MultipartEntity>& multipart,
+                                      RequestPriority priority);
+
+        // Performs request with retries, throws RESTError for non-2xx status.
+        // Non-empty cacheKey enables negative caching of 404 responses.
+        REST::HTTPResponse performRawRequest(const std::string& method,
+                                             boost::string_view endpoint,
+                                             boost::string_view bucket,
+                                             boost::string_view routeName,
+                                             const std::string& queryString,
+                                             const nlohmann::json& payload,
+                                             const std::vector<REST::MultipartEntity>& multipart,
+                                             RequestPriority priority,
+                                             const std::string& cacheKey);
+
         void prepareRequestBody(REST::HTTPRequest& request,
                                 const nlohmann::json& payload,
                                 const std::vector<REST::MultipartEntity>& elements);
 
         // Throws RESTError or inherited class.
-        void throwRestError(const REST::HTTPResponse& response, const nlohmann::json& payload);
+        void throwRestError(unsigned statusCode, const nlohmann::json& payload);
+
+        // Remove cached responses for endpoints matching pattern, if cache is enabled.
+        void invalidateCached(const std::string& pattern);
 
 #ifdef HEXICORD_RATELIMIT_PREDICTION
-        void updateRatelimitsIfPresent(const std::string& endpoint, const std::unordered_map<std::string, std::string>& headers);
+        void updateRatelimitsIfPresent(boost::string_view bucket, const REST::HTTPResponse& response);
 #endif
 
         static inline REST::MultipartEntity fileToMultipartEntity(const File& file);
 
+        // Value of Authorization header, set by getGatewayUrl or getGatewayUrlBot.
+        // Accessed using std::atomic_load and std::atomic_store, because
+        // it can be set while other threads perform requests.
+        std::shared_ptr<const std::string> authorization;
+
         // We have to use std::shared_ptr instead of std::unique_ptr because
         // latter requires complete type but we forward-declare REST::HTTPSConnection.
-        std::shared_ptr<REST::HTTPSConnection> restConnection;
+        std::vector<std::shared_ptr<REST::HTTPSConnection>> connections;
+
+        // Gives access to connections, one request per connection at time.
+        std::shared_ptr<RequestScheduler> scheduler;
         boost::asio::io_service& ioService; // non-owning reference to I/O service.
     };
 } // namespace Hexicord
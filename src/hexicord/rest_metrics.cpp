@@ -0,0 +1,186 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/rest_metrics.hpp"
+
+#include <sstream>      // std::ostringstream
+#include <utility>      // std::move
+
+namespace Hexicord {
+    namespace {
+        double toSeconds(RestMetrics::Clock::duration duration) {
+            return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+        }
+
+        // Label values can contain anything, but route and bucket
+        // keys normally don't contain characters that need escaping.
+        std::string escapeLabel(const std::string& value) {
+            std::string result;
+            result.reserve(value.size());
+            for (char ch : value) {
+                if (ch == '\\' || ch == '"') {
+                    result += '\\';
+                    result += ch;
+                } else if (ch == '\n') {
+                    result += "\\n";
+                } else {
+                    result += ch;
+                }
+            }
+            return result;
+        }
+
+        template<typename Map, typename Getter>
+        void writeCounter(std::ostringstream& out, const std::string& name, const std::string& label,
+                          const Map& map, Getter getter) {
+            out << "# TYPE " << name << " counter\n";
+            for (const auto& pair : map) {
+                out << name << '{' << label << "=\"" << escapeLabel(pair.first) << "\"} " << getter(pair.second) << '\n';
+            }
+        }
+
+        void writeHistogram(std::ostringstream& out, const std::string& name,
+                            const std::map<std::string, RestMetrics::RouteStats>& routes,
+                            Histogram RestMetrics::RouteStats::*member) {
+            out << "# TYPE " << name << " histogram\n";
+            for (const auto& pair : routes) {
+                const Histogram& histogram = pair.second.*member;
+                const std::string route = escapeLabel(pair.first);
+
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i < Histogram::BoundsCount; ++i) {
+                    cumulative += histogram.counts[i];
+                    out << name << "_bucket{route=\"" << route << "\",le=\"" << Histogram::bounds[i] << "\"} " << cumulative << '\n';
+                }
+                out << name << "_bucket{route=\"" << route << "\",le=\"+Inf\"} " << histogram.count << '\n';
+                out << name << "_sum{route=\"" << route << "\"} " << histogram.sum << '\n';
+                out << name << "_count{route=\"" << route << "\"} " << histogram.count << '\n';
+            }
+        }
+    } // namespace
+
+    constexpr size_t Histogram::BoundsCount;
+    const std::array<double, Histogram::BoundsCount> Histogram::bounds {{
+        0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+    }};
+
+    const std::string RestMetrics::OtherBucket = "other";
+
+    RestMetrics::RestMetrics(size_t maxBuckets)
+        : maxBuckets(maxBuckets) {}
+
+    void Histogram::observe(double seconds) {
+        size_t i = 0;
+        while (i < BoundsCount && seconds > bounds[i]) ++i;
+        ++counts[i];
+        ++count;
+        sum += seconds;
+    }
+
+    RestMetrics::Snapshot RestMetrics::snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    std::string RestMetrics::toPrometheus(const std::string& prefix) const {
+        Snapshot copy = snapshot();
+
+        std::ostringstream out;
+        out.precision(10);
+        writeCounter(out, prefix + "_requests_total", "route", copy.routes,
+                     [](const RouteStats& route) { return route.requests; });
+        writeCounter(out, prefix + "_errors_total", "route", copy.routes,
+                     [](const RouteStats& route) { return route.errors; });
+        writeCounter(out, prefix + "_ratelimited_total", "route", copy.routes,
+                     [](const RouteStats& route) { return route.ratelimited; });
+        writeCounter(out, prefix + "_retries_total", "route", copy.routes,
+                     [](const RouteStats& route) { return route.retries; });
+        writeCounter(out, prefix + "_sent_bytes_total", "route", copy.routes,
+                     [](const RouteStats& route) { return route.bytesSent; });
+        writeCounter(out, prefix + "_received_bytes_total", "route", copy.routes,
+                     [](const RouteStats& route) { return route.bytesReceived; });
+
+        writeHistogram(out, prefix + "_request_duration_seconds",  copy.routes, &RouteStats::latency);
+        writeHistogram(out, prefix + "_queue_wait_seconds",        copy.routes, &RouteStats::queueWait);
+        writeHistogram(out, prefix + "_ratelimit_wait_seconds",    copy.routes, &RouteStats::ratelimitWait);
+        writeHistogram(out, prefix + "_backoff_wait_seconds",      copy.routes, &RouteStats::backoffWait);
+
+        writeCounter(out, prefix + "_bucket_ratelimited_total", "bucket", copy.buckets,
+                     [](const BucketStats& bucket) { return bucket.ratelimited; });
+        writeCounter(out, prefix + "_bucket_ratelimit_wait_seconds_total", "bucket", copy.buckets,
+                     [](const BucketStats& bucket) { return bucket.ratelimitWaitSeconds; });
+
+        return out.str();
+    }
+
+    void RestMetrics::reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats = Snapshot();
+    }
+
+    void RestMetrics::recordAttempt(const std::string& route, unsigned statusCode,
+                                    Clock::duration queueWait, Clock::duration latency,
+                                    uint64_t bytesSent, uint64_t bytesReceived) {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        RouteStats& routeStats = stats.routes[route];
+
+        if (statusCode != 0) ++routeStats.requests;
+        if (statusCode / 100 != 2) ++routeStats.errors;
+        routeStats.bytesSent     += bytesSent;
+        routeStats.bytesReceived += bytesReceived;
+        routeStats.queueWait.observe(toSeconds(queueWait));
+        routeStats.latency.observe(toSeconds(latency));
+    }
+
+    void RestMetrics::recordRetry(const std::string& route) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.routes[route].retries;
+    }
+
+    void RestMetrics::recordRatelimitWait(const std::string& route, const std::string& bucket, Clock::duration wait) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.routes[route].ratelimitWait.observe(toSeconds(wait));
+        // Called for every request, so buckets that never waited are not tracked.
+        if (wait > Clock::duration::zero()) bucketStats(bucket).ratelimitWaitSeconds += toSeconds(wait);
+    }
+
+    void RestMetrics::recordRatelimitHit(const std::string& route, const std::string& bucket) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.routes[route].ratelimited;
+        ++bucketStats(bucket).ratelimited;
+    }
+
+    void RestMetrics::recordBackoff(const std::string& route, Clock::duration wait) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.routes[route].backoffWait.observe(toSeconds(wait));
+    }
+
+    RestMetrics::BucketStats& RestMetrics::bucketStats(const std::string& bucket) {
+        auto it = stats.buckets.find(bucket);
+        if (it != stats.buckets.end()) return it->second;
+
+        // OtherBucket itself doesn't count towards limit.
+        if (stats.buckets.size() - stats.buckets.count(OtherBucket) >= maxBuckets) return stats.buckets[OtherBucket];
+        return stats.buckets[bucket];
+    }
+} // namespace Hexicord
@@ -0,0 +1,147 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_REST_METRICS_HPP
+#define HEXICORD_REST_METRICS_HPP
+
+#include <array>                // std::array
+#include <chrono>               // std::chrono::steady_clock
+#include <cstdint>              // uint64_t
+#include <map>                  // std::map
+#include <mutex>                // std::mutex
+#include <string>               // std::string
+
+namespace Hexicord {
+    /**
+     * Distribution of durations (in seconds) with fixed bucket bounds,
+     * same as default bounds of Prometheus client libraries.
+     */
+    struct Histogram {
+        static constexpr size_t BoundsCount = 11;
+        static const std::array<double, BoundsCount> bounds;
+
+        void observe(double seconds);
+
+        /// counts[i] is count of values <= bounds[i] and > bounds[i-1],
+        /// last element counts values bigger than any bound.
+        std::array<uint64_t, BoundsCount + 1> counts {};
+        uint64_t count = 0;
+        double sum = 0;
+    };
+
+    /**
+     * Counters and histograms of REST requests, grouped by route pattern
+     * (like "/channels/{channel}/messages") and by ratelimit bucket.
+     *
+     * Bucket keys contain channel, guild and webhook ids, so count of
+     * tracked buckets is limited: buckets seen after limit is reached
+     * are counted together under "other" key.
+     *
+     * Disabled by default, enable it by assigning instance to
+     * \ref RestClient::metrics. Same instance can be shared between
+     * multiple clients.
+     *
+     * ```cpp
+     * rclient.metrics = std::make_shared<Hexicord::RestMetrics>();
+     * // ... later, in HTTP handler of /metrics:
+     * return rclient.metrics->toPrometheus();
+     * ```
+     *
+     * All methods are thread-safe.
+     */
+    class RestMetrics {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// Key used for buckets over limit.
+        static const std::string OtherBucket;
+
+        /**
+         * \param maxBuckets Max count of separately tracked ratelimit buckets.
+         */
+        explicit RestMetrics(size_t maxBuckets = 256);
+
+        struct RouteStats {
+            uint64_t requests      = 0; ///< Attempts that got response.
+            uint64_t errors        = 0; ///< Non-2xx responses and connection errors.
+            uint64_t ratelimited   = 0; ///< 429 responses.
+            uint64_t retries       = 0; ///< Repeated attempts.
+            uint64_t bytesSent     = 0; ///< Request bodies.
+            uint64_t bytesReceived = 0; ///< Response bodies (after decompression).
+
+            Histogram latency;       ///< Sending request and reading response.
+            Histogram queueWait;     ///< Waiting for free connection.
+            Histogram ratelimitWait; ///< Waiting in RatelimitLock and after 429.
+            Histogram backoffWait;   ///< Sleeping before retry after error.
+        };
+
+        struct BucketStats {
+            uint64_t ratelimited = 0;
+            double ratelimitWaitSeconds = 0;
+        };
+
+        struct Snapshot {
+            std::map<std::string, RouteStats> routes;
+            std::map<std::string, BucketStats> buckets;
+        };
+
+        /// Copy of all collected values.
+        Snapshot snapshot() const;
+
+        /**
+         * Values in Prometheus text exposition format, metric names are
+         * prefixed with prefix.
+         */
+        std::string toPrometheus(const std::string& prefix = "hexicord_rest") const;
+
+        void reset();
+
+        /// \name Used by RestClient.
+        /// @{
+
+        /// Attempt that received response (statusCode != 0) or failed with
+        /// connection error (statusCode == 0).
+        void recordAttempt(const std::string& route, unsigned statusCode,
+                           Clock::duration queueWait, Clock::duration latency,
+                           uint64_t bytesSent, uint64_t bytesReceived);
+
+        void recordRetry(const std::string& route);
+
+        void recordRatelimitWait(const std::string& route, const std::string& bucket, Clock::duration wait);
+
+        void recordRatelimitHit(const std::string& route, const std::string& bucket);
+
+        void recordBackoff(const std::string& route, Clock::duration wait);
+
+        /// @}
+
+        const size_t maxBuckets;
+    private:
+        // Stats of bucket, or of OtherBucket if limit is reached. Call under lock.
+        BucketStats& bucketStats(const std::string& bucket);
+
+        Snapshot stats;
+        mutable std::mutex mutex;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_REST_METRICS_HPP
@@ -0,0 +1,95 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/retry_policy.hpp"
+
+#include <algorithm>                    // std::min
+#include <random>                       // std::mt19937, std::random_device, std::uniform_int_distribution
+#include "hexicord/config.hpp"          // HEXICORD_DEBUG_LOG
+
+#ifdef HEXICORD_DEBUG_LOG
+    #include <iostream>
+    #define DEBUG_MSG(msg) do { std::cerr << "retry_policy.cpp:" << __LINE__ << "\t" << (msg) << '\n'; } while (false)
+#else
+    #define DEBUG_MSG(msg)
+#endif
+
+namespace Hexicord {
+    std::chrono::milliseconds RetryPolicy::backoff(unsigned retry) const {
+        thread_local std::mt19937 generator{ std::random_device{}() };
+
+        using Rep = std::chrono::milliseconds::rep;
+        Rep limit = baseDelay.count();
+        for (unsigned i = 1; i < retry && limit < maxDelay.count(); ++i) limit *= 2;
+        limit = std::min(limit, Rep(maxDelay.count()));
+
+        std::uniform_int_distribution<Rep> distribution(limit / 2, limit);
+        return std::chrono::milliseconds(distribution(generator));
+    }
+
+    bool RetryPolicy::isIdempotent(const std::string& method) {
+        return method == "GET" || method == "HEAD" || method == "PUT" ||
+               method == "DELETE" || method == "OPTIONS";
+    }
+
+    CircuitBreaker::CircuitBreaker(unsigned failureThreshold, std::chrono::seconds cooldown)
+        : failureThreshold(failureThreshold)
+        , cooldown(cooldown) {}
+
+    bool CircuitBreaker::allow(const std::string& route) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = routes.find(route);
+        if (it == routes.end() || it->second.failures < failureThreshold) return true;
+
+        // Open. After cooldown let one request through to check if route recovered.
+        if (Clock::now() < it->second.openUntil || it->second.probing) return false;
+
+        DEBUG_MSG(std::string("Probing route ") + route);
+        it->second.probing = true;
+        return true;
+    }
+
+    void CircuitBreaker::recordSuccess(const std::string& route) {
+        std::lock_guard<std::mutex> lock(mutex);
+        routes.erase(route);
+    }
+
+    void CircuitBreaker::recordFailure(const std::string& route) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        State& state = routes[route];
+        state.probing = false;
+        if (++state.failures >= failureThreshold) {
+            DEBUG_MSG(std::string("Opening circuit for route ") + route);
+            state.openUntil = Clock::now() + cooldown;
+        }
+    }
+
+    bool CircuitBreaker::isOpen(const std::string& route) const {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = routes.find(route);
+        return it != routes.end() && it->second.failures >= failureThreshold &&
+               Clock::now() < it->second.openUntil;
+    }
+} // namespace Hexicord
@@ -0,0 +1,113 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_RETRY_POLICY_HPP
+#define HEXICORD_RETRY_POLICY_HPP
+
+#include <chrono>               // std::chrono::milliseconds, std::chrono::steady_clock
+#include <mutex>                // std::mutex
+#include <string>               // std::string
+#include <unordered_map>        // std::unordered_map
+
+namespace Hexicord {
+    /**
+     * Controls how \ref RestClient retries failed requests.
+     *
+     * Following failures are retried:
+     * - Connection closed by server while sending request (stale keep-alive
+     *   connection), for any method, without delay.
+     * - Failed connection attempt, for any method.
+     * - 5xx responses, only for idempotent methods (see \ref isIdempotent).
+     * - 429 responses, after delay returned by server (unless
+     *   HEXICORD_RATELIMIT_HIT_AS_ERROR is set).
+     *
+     * Error of last attempt is thrown when attempts are exhausted.
+     */
+    struct RetryPolicy {
+        /// Total count of attempts including first one, 1 disables retries.
+        unsigned maxAttempts = 5;
+
+        /// Delay before first retry, doubled for each next one.
+        std::chrono::milliseconds baseDelay = std::chrono::milliseconds(250);
+
+        /// Upper bound for delay between attempts.
+        std::chrono::milliseconds maxDelay = std::chrono::milliseconds(10000);
+
+        /**
+         * Delay before retry number `retry` (starting from 1): random value
+         * between half and full of min(maxDelay, baseDelay * 2^(retry-1)),
+         * so clients failed at same time don't retry at same time.
+         */
+        std::chrono::milliseconds backoff(unsigned retry) const;
+
+        /// True for methods that can be safely repeated: GET, HEAD, PUT, DELETE, OPTIONS.
+        static bool isIdempotent(const std::string& method);
+    };
+
+    /**
+     * Per-route circuit breaker.
+     *
+     * After failureThreshold consecutive failures (5xx or network errors)
+     * route is "open" for cooldown period: requests to it fail immediately
+     * with \ref CircuitOpen instead of waiting for timeouts and retries.
+     * After cooldown one request is let through, route is closed again if
+     * it succeeds.
+     *
+     * All methods are thread-safe.
+     */
+    class CircuitBreaker {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit CircuitBreaker(unsigned failureThreshold = 5,
+                                std::chrono::seconds cooldown = std::chrono::seconds(30));
+
+        /**
+         * Check whether request to route can be performed now. Caller is
+         * expected to report result using \ref recordSuccess or
+         * \ref recordFailure if true is returned.
+         */
+        bool allow(const std::string& route);
+
+        void recordSuccess(const std::string& route);
+        void recordFailure(const std::string& route);
+
+        /// True if requests to route are currently rejected.
+        bool isOpen(const std::string& route) const;
+
+        const unsigned failureThreshold;
+        const std::chrono::seconds cooldown;
+    private:
+        struct State {
+            unsigned failures = 0;
+            Clock::time_point openUntil;
+            bool probing = false;
+        };
+
+        // Only routes with recent failures are stored.
+        std::unordered_map<std::string, State> routes;
+
+        mutable std::mutex mutex;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_RETRY_POLICY_HPP
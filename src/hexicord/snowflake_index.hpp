@@ -0,0 +1,298 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_SNOWFLAKE_INDEX_HPP
+#define HEXICORD_SNOWFLAKE_INDEX_HPP
+
+#include <algorithm>                     // std::lower_bound, std::upper_bound
+#include <cstddef>                       // size_t
+#include <cstdint>                       // uint8_t, uint64_t
+#include <iterator>                      // std::make_move_iterator
+#include <utility>                       // std::move
+#include <vector>                        // std::vector
+#include "hexicord/types/snowflake.hpp"  // Hexicord::Snowflake
+
+/**
+ * Time-ordered index of values keyed by snowflake.
+ */
+
+namespace Hexicord {
+    namespace _Detail {
+        inline void writeVarint(std::vector<uint8_t>& output, uint64_t value) {
+            while (value >= 0x80) {
+                output.push_back(uint8_t(value) | 0x80);
+                value >>= 7;
+            }
+            output.push_back(uint8_t(value));
+        }
+
+        inline uint64_t readVarint(const uint8_t*& input) {
+            uint64_t value = 0;
+            unsigned shift = 0;
+            while (*input & 0x80) {
+                value |= uint64_t(*input++ & 0x7f) << shift;
+                shift += 7;
+            }
+            value |= uint64_t(*input++) << shift;
+            return value;
+        }
+    } // namespace _Detail
+
+    /**
+     * Sorted map from snowflake to \p T, optimized for time range queries.
+     *
+     * Snowflakes are ordered by creation time, so sorting by ID sorts by time
+     * too. Entries are split into blocks of up to BlockSize entries. Block
+     * keeps first ID as is and following IDs as varint-encoded deltas from
+     * previous one, so IDs take about 5 bytes instead of 8 for typical
+     * message history. Lookups binary-search blocks and decode one block.
+     *
+     * Appending IDs in increasing order (as they arrive from gateway or
+     * from \ref Paginator) is cheapest, out-of-order insert and erase
+     * re-encode one block.
+     *
+     * Pointers to values are invalidated by any modification.
+     */
+    template<typename T>
+    class SnowflakeIndex {
+    public:
+        static constexpr size_t BlockSize = 128;
+
+        size_t size()  const { return size_; }
+        bool   empty() const { return size_ == 0; }
+
+        void clear() {
+            blocks.clear();
+            size_ = 0;
+        }
+
+        /**
+         * Inserts \p value with key \p id, replacing existing value if any.
+         *
+         * \returns true if new entry was inserted, false if value was replaced.
+         */
+        bool insert(Snowflake id, T value) {
+            // Fast path: append.
+            if (blocks.empty() || id > blocks.back().last) {
+                if (blocks.empty() || blocks.back().values.size() >= BlockSize) {
+                    blocks.emplace_back(id);
+                } else {
+                    _Detail::writeVarint(blocks.back().deltas, id - blocks.back().last);
+                    blocks.back().last = id;
+                }
+                blocks.back().values.push_back(std::move(value));
+                ++size_;
+                return true;
+            }
+
+            auto block = findBlock(id);
+            std::vector<uint64_t> ids = block->decode();
+            auto position = std::lower_bound(ids.begin(), ids.end(), uint64_t(id));
+            size_t index = size_t(position - ids.begin());
+            if (position != ids.end() && *position == id) {
+                block->values[index] = std::move(value);
+                return false;
+            }
+
+            ids.insert(position, id);
+            block->values.insert(block->values.begin() + index, std::move(value));
+            ++size_;
+
+            if (ids.size() <= BlockSize) {
+                block->encode(ids.begin(), ids.end());
+            } else {
+                // Split in halves, so following inserts nearby don't split again.
+                size_t half = ids.size() / 2;
+                Block second(ids[half]);
+                second.encode(ids.begin() + half, ids.end());
+                second.values.assign(std::make_move_iterator(block->values.begin() + half),
+                                     std::make_move_iterator(block->values.end()));
+                block->values.erase(block->values.begin() + half, block->values.end());
+                block->encode(ids.begin(), ids.begin() + half);
+                blocks.insert(block + 1, std::move(second));
+            }
+            return true;
+        }
+
+        /**
+         * Removes entry with key \p id.
+         *
+         * \returns true if entry was removed.
+         */
+        bool erase(Snowflake id) {
+            auto block = findBlock(id);
+            if (block == blocks.end()) return false;
+
+            std::vector<uint64_t> ids = block->decode();
+            auto position = std::lower_bound(ids.begin(), ids.end(), uint64_t(id));
+            if (position == ids.end() || *position != id) return false;
+
+            block->values.erase(block->values.begin() + (position - ids.begin()));
+            ids.erase(position);
+            --size_;
+
+            if (ids.empty()) {
+                blocks.erase(block);
+            } else {
+                block->encode(ids.begin(), ids.end());
+            }
+            return true;
+        }
+
+        /// \returns Pointer to value with key \p id or nullptr if there is no such entry.
+        T* find(Snowflake id) {
+            return const_cast<T*>(static_cast<const SnowflakeIndex*>(this)->find(id));
+        }
+
+        /// \returns Pointer to value with key \p id or nullptr if there is no such entry.
+        const T* find(Snowflake id) const {
+            auto block = findBlock(id);
+            if (block == blocks.end()) return nullptr;
+
+            const T* result = nullptr;
+            block->forEach([&result, id](uint64_t current, const T& value) -> bool {
+                if (current == id) result = &value;
+                return current < id;
+            });
+            return result;
+        }
+
+        /**
+         * Calls \p callback(Snowflake, const T&) for each entry with
+         * \p begin <= ID < \p end, in ascending order.
+         */
+        template<typename Callback>
+        void forEachInRange(Snowflake begin, Snowflake end, Callback callback) const {
+            if (begin >= end) return;
+
+            for (auto block = findBlock(begin); block != blocks.end() && block->first < end; ++block) {
+                block->forEach([&callback, begin, end](uint64_t id, const T& value) -> bool {
+                    if (id >= end) return false;
+                    if (id >= begin) callback(Snowflake(id), value);
+                    return true;
+                });
+            }
+        }
+
+        /**
+         * Calls \p callback(Snowflake, const T&) for each entry created
+         * in [\p beginMs, \p endMs) (milliseconds since Unix epoch), in
+         * ascending order.
+         */
+        template<typename Callback>
+        void forEachInTimeRange(uint64_t beginMs, uint64_t endMs, Callback callback) const {
+            forEachInRange(Snowflake::fromUnixTimestampMs(beginMs), Snowflake::fromUnixTimestampMs(endMs), callback);
+        }
+
+        /**
+         * Number of entries with \p begin <= ID < \p end.
+         *
+         * Blocks fully inside the range are counted without decoding.
+         */
+        size_t countInRange(Snowflake begin, Snowflake end) const {
+            if (begin >= end) return 0;
+
+            size_t count = 0;
+            for (auto block = findBlock(begin); block != blocks.end() && block->first < end; ++block) {
+                if (block->first >= begin && block->last < end) {
+                    count += block->values.size();
+                    continue;
+                }
+                block->forEach([&count, begin, end](uint64_t id, const T&) -> bool {
+                    if (id >= end) return false;
+                    if (id >= begin) ++count;
+                    return true;
+                });
+            }
+            return count;
+        }
+
+        /// Calls \p callback(Snowflake, const T&) for each entry in ascending order.
+        template<typename Callback>
+        void forEach(Callback callback) const {
+            for (const Block& block : blocks) {
+                block.forEach([&callback](uint64_t id, const T& value) -> bool {
+                    callback(Snowflake(id), value);
+                    return true;
+                });
+            }
+        }
+    private:
+        struct Block {
+            explicit Block(uint64_t first) : first(first), last(first) {}
+
+            std::vector<uint64_t> decode() const {
+                std::vector<uint64_t> ids;
+                ids.reserve(values.size());
+                ids.push_back(first);
+                const uint8_t* input = deltas.data();
+                for (size_t i = 1; i < values.size(); ++i) ids.push_back(ids.back() + _Detail::readVarint(input));
+                return ids;
+            }
+
+            template<typename Iterator>
+            void encode(Iterator begin, Iterator end) {
+                deltas.clear();
+                first = last = *begin;
+                for (++begin; begin != end; ++begin) {
+                    _Detail::writeVarint(deltas, *begin - last);
+                    last = *begin;
+                }
+            }
+
+            // Calls callback(id, value) until it returns false.
+            template<typename Callback>
+            void forEach(Callback callback) const {
+                uint64_t id = first;
+                const uint8_t* input = deltas.data();
+                for (size_t i = 0; i < values.size(); ++i) {
+                    if (i != 0) id += _Detail::readVarint(input);
+                    if (!callback(id, values[i])) return;
+                }
+            }
+
+            uint64_t first;
+            uint64_t last;
+            std::vector<uint8_t> deltas;
+            std::vector<T> values;
+        };
+
+        // First block that may contain id (its last ID is not smaller).
+        typename std::vector<Block>::iterator findBlock(uint64_t id) {
+            return std::lower_bound(blocks.begin(), blocks.end(), id,
+                                    [](const Block& block, uint64_t value) { return block.last < value; });
+        }
+
+        typename std::vector<Block>::const_iterator findBlock(uint64_t id) const {
+            return std::lower_bound(blocks.begin(), blocks.end(), id,
+                                    [](const Block& block, uint64_t value) { return block.last < value; });
+        }
+
+        std::vector<Block> blocks;
+        size_t size_ = 0;
+    };
+
+    template<typename T>
+    constexpr size_t SnowflakeIndex<T>::BlockSize;
+} // namespace Hexicord
+
+#endif // HEXICORD_SNOWFLAKE_INDEX_HPP
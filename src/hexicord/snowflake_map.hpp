@@ -0,0 +1,489 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_SNOWFLAKE_MAP_HPP
+#define HEXICORD_SNOWFLAKE_MAP_HPP
+
+#include <cstddef>                       // size_t, std::ptrdiff_t, std::max_align_t
+#include <cstdint>                       // uint8_t, int8_t, uint32_t, uint64_t
+#include <cstring>                       // std::memset
+#include <iterator>                      // std::forward_iterator_tag
+#include <new>                           // ::operator new, placement new
+#include <stdexcept>                     // std::out_of_range
+#include <tuple>                         // std::forward_as_tuple
+#include <type_traits>                   // std::conditional
+#include <utility>                       // std::pair, std::move, std::forward, std::swap
+#include "hexicord/types/snowflake.hpp"  // Hexicord::Snowflake
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define HEXICORD_SNOWFLAKE_MAP_SSE2
+    #include <emmintrin.h>               // SSE2 intrinsics
+#endif
+#ifdef _MSC_VER
+    #include <intrin.h>                  // _BitScanForward
+#endif
+
+/**
+ * Flat hash containers keyed by snowflake.
+ *
+ * Open addressing with one control byte per slot, probed 16 slots at a time
+ * (with SSE2 when available). Values are stored inline in a single
+ * allocation, so unlike std::map or std::unordered_map there is no per-element
+ * node. Keys are hashed using Snowflake::hash, raw value is never used.
+ *
+ * Like std::unordered_map, insertion may invalidate all iterators and
+ * references. Erasure invalidates only iterators and references to erased
+ * element.
+ */
+
+namespace Hexicord {
+    namespace _Detail {
+        // Control byte: 0..127 - slot is full, value is lower 7 bits of hash.
+        constexpr int8_t CtrlEmpty   = -128;
+        constexpr int8_t CtrlDeleted = -2;
+        constexpr size_t GroupSize   = 16;
+
+        inline unsigned lowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return unsigned(index);
+#else
+            return unsigned(__builtin_ctz(mask));
+#endif
+        }
+
+        // GroupSize control bytes, matched at once. Results are bit masks,
+        // bit N is set if Nth byte matches.
+        class Group {
+        public:
+            explicit Group(const int8_t* ctrl) {
+#ifdef HEXICORD_SNOWFLAKE_MAP_SSE2
+                bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+                std::memcpy(bytes, ctrl, GroupSize);
+#endif
+            }
+
+            uint32_t match(int8_t h2) const {
+#ifdef HEXICORD_SNOWFLAKE_MAP_SSE2
+                return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), bytes)));
+#else
+                uint32_t mask = 0;
+                for (size_t i = 0; i < GroupSize; ++i) mask |= uint32_t(bytes[i] == h2) << i;
+                return mask;
+#endif
+            }
+
+            uint32_t matchEmpty() const {
+                return match(CtrlEmpty);
+            }
+
+            uint32_t matchEmptyOrDeleted() const {
+#ifdef HEXICORD_SNOWFLAKE_MAP_SSE2
+                return uint32_t(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), bytes)));
+#else
+                uint32_t mask = 0;
+                for (size_t i = 0; i < GroupSize; ++i) mask |= uint32_t(bytes[i] < -1) << i;
+                return mask;
+#endif
+            }
+
+        private:
+#ifdef HEXICORD_SNOWFLAKE_MAP_SSE2
+            __m128i bytes;
+#else
+            int8_t bytes[GroupSize];
+#endif
+        };
+
+        struct MapKeyOf {
+            template<typename Pair>
+            static Snowflake get(const Pair& pair) { return pair.first; }
+        };
+
+        struct SetKeyOf {
+            static Snowflake get(Snowflake key) { return key; }
+        };
+
+        /**
+         * Table shared by SnowflakeMap and SnowflakeSet.
+         *
+         * Capacity is zero or power of two not less than GroupSize. Groups
+         * are aligned to GroupSize and probed in triangular sequence, which
+         * visits every group for power-of-two group count. Lookup stops at
+         * first group with empty slot, so erase can mark slot empty (and
+         * reuse it) only if its group already has one, otherwise it leaves
+         * a tombstone.
+         */
+        template<typename Value, typename KeyOf, bool MutableValues>
+        class SnowflakeTable {
+            template<bool Const>
+            class Iterator {
+                friend class SnowflakeTable;
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = Value;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = typename std::conditional<Const, const Value*, Value*>::type;
+                using reference         = typename std::conditional<Const, const Value&, Value&>::type;
+
+                Iterator() = default;
+
+                // iterator -> const_iterator.
+                template<bool OtherConst, typename = typename std::enable_if<Const && !OtherConst>::type>
+                Iterator(const Iterator<OtherConst>& other)
+                    : ctrl(other.ctrl), slot(other.slot), ctrlEnd(other.ctrlEnd) {}
+
+                reference operator*()  const { return *slot; }
+                pointer   operator->() const { return slot; }
+
+                Iterator& operator++() {
+                    ++ctrl;
+                    ++slot;
+                    skipFree();
+                    return *this;
+                }
+
+                Iterator operator++(int) {
+                    Iterator copy = *this;
+                    ++*this;
+                    return copy;
+                }
+
+                friend bool operator==(const Iterator& lhs, const Iterator& rhs) { return lhs.ctrl == rhs.ctrl; }
+                friend bool operator!=(const Iterator& lhs, const Iterator& rhs) { return lhs.ctrl != rhs.ctrl; }
+            private:
+                template<bool> friend class Iterator;
+
+                Iterator(const int8_t* ctrl, pointer slot, const int8_t* ctrlEnd)
+                    : ctrl(ctrl), slot(slot), ctrlEnd(ctrlEnd) {}
+
+                void skipFree() {
+                    while (ctrl != ctrlEnd && *ctrl < 0) {
+                        ++ctrl;
+                        ++slot;
+                    }
+                }
+
+                const int8_t* ctrl    = nullptr;
+                pointer       slot    = nullptr;
+                const int8_t* ctrlEnd = nullptr;
+            };
+        public:
+            using key_type        = Snowflake;
+            using value_type      = Value;
+            using size_type       = size_t;
+            using reference       = value_type&;
+            using const_reference = const value_type&;
+            using const_iterator  = Iterator<true>;
+            using iterator        = Iterator<!MutableValues>;
+
+            SnowflakeTable() = default;
+
+            SnowflakeTable(const SnowflakeTable& other) {
+                reserve(other.size_);
+                for (const Value& value : other) emplaceKey(KeyOf::get(value), value);
+            }
+
+            SnowflakeTable(SnowflakeTable&& other) noexcept {
+                swap(other);
+            }
+
+            SnowflakeTable& operator=(SnowflakeTable other) noexcept {
+                swap(other);
+                return *this;
+            }
+
+            ~SnowflakeTable() {
+                destroy();
+            }
+
+            void swap(SnowflakeTable& other) noexcept {
+                std::swap(slots,      other.slots);
+                std::swap(ctrl,       other.ctrl);
+                std::swap(capacity_,  other.capacity_);
+                std::swap(size_,      other.size_);
+                std::swap(growthLeft, other.growthLeft);
+            }
+
+            iterator begin() {
+                iterator it(ctrl, slots, ctrl + capacity_);
+                it.skipFree();
+                return it;
+            }
+
+            const_iterator begin() const {
+                const_iterator it(ctrl, slots, ctrl + capacity_);
+                it.skipFree();
+                return it;
+            }
+
+            iterator       end()          { return iterator(ctrl + capacity_, slots + capacity_, ctrl + capacity_); }
+            const_iterator end()    const { return const_iterator(ctrl + capacity_, slots + capacity_, ctrl + capacity_); }
+            const_iterator cbegin() const { return begin(); }
+            const_iterator cend()   const { return end(); }
+
+            size_t size()     const { return size_; }
+            bool   empty()    const { return size_ == 0; }
+            size_t capacity() const { return capacity_; }
+
+            iterator find(Snowflake key) {
+                size_t index = findIndex(key);
+                return index == capacity_ ? end() : iteratorAt(index);
+            }
+
+            const_iterator find(Snowflake key) const {
+                size_t index = findIndex(key);
+                return index == capacity_ ? end() : const_iterator(ctrl + index, slots + index, ctrl + capacity_);
+            }
+
+            size_t count(Snowflake key) const {
+                return findIndex(key) == capacity_ ? 0 : 1;
+            }
+
+            size_t erase(Snowflake key) {
+                size_t index = findIndex(key);
+                if (index == capacity_) return 0;
+                eraseAt(index);
+                return 1;
+            }
+
+            /// Returns iterator to element following erased one.
+            iterator erase(const_iterator position) {
+                size_t index = size_t(position.ctrl - ctrl);
+                eraseAt(index);
+                iterator next = iteratorAt(index);
+                next.skipFree();
+                return next;
+            }
+
+            /// Makes room for at least \p count elements without rehashing.
+            void reserve(size_t count) {
+                size_t newCapacity = GroupSize;
+                while (maxLoad(newCapacity) < count) newCapacity *= 2;
+                if (newCapacity > capacity_) rehash(newCapacity);
+            }
+
+            void clear() {
+                if (capacity_ == 0) return;
+                for (size_t i = 0; i < capacity_; ++i) {
+                    if (ctrl[i] >= 0) slots[i].~Value();
+                }
+                std::memset(ctrl, CtrlEmpty, capacity_);
+                size_ = 0;
+                growthLeft = maxLoad(capacity_);
+            }
+        protected:
+            /**
+             * Constructs value from \p args in slot for \p key, if there is
+             * no element with this key yet. Second member of result is true
+             * if value was inserted.
+             */
+            template<typename... Args>
+            std::pair<iterator, bool> emplaceKey(Snowflake key, Args&&... args) {
+                uint64_t hash = key.hash();
+                size_t index = findIndex(key, hash);
+                if (index != capacity_) return { iteratorAt(index), false };
+
+                index = findFreeIndex(hash);
+                if (growthLeft == 0 && (capacity_ == 0 || ctrl[index] != CtrlDeleted)) {
+                    // Enough tombstones to reclaim - rehash in place, otherwise grow.
+                    rehash(size_ * 2 < maxLoad(capacity_) ? capacity_ : (capacity_ == 0 ? GroupSize : capacity_ * 2));
+                    index = findFreeIndex(hash);
+                }
+
+                new (slots + index) Value(std::forward<Args>(args)...);
+                if (ctrl[index] == CtrlEmpty) --growthLeft;
+                ctrl[index] = h2(hash);
+                ++size_;
+                return { iteratorAt(index), true };
+            }
+        private:
+            static constexpr size_t maxLoad(size_t capacity) { return capacity - capacity / 8; }
+            static int8_t h2(uint64_t hash) { return int8_t(hash & 0x7f); }
+            size_t firstGroup(uint64_t hash) const { return size_t(hash >> 7) & (capacity_ / GroupSize - 1); }
+
+            iterator iteratorAt(size_t index) {
+                return iterator(ctrl + index, slots + index, ctrl + capacity_);
+            }
+
+            size_t findIndex(Snowflake key) const {
+                return findIndex(key, key.hash());
+            }
+
+            // Returns capacity_ if key is not found.
+            size_t findIndex(Snowflake key, uint64_t hash) const {
+                if (size_ == 0) return capacity_;
+
+                size_t groupMask = capacity_ / GroupSize - 1;
+                size_t group = firstGroup(hash);
+                for (size_t step = 1; step <= capacity_ / GroupSize; ++step) {
+                    Group g(ctrl + group * GroupSize);
+                    for (uint32_t mask = g.match(h2(hash)); mask != 0; mask &= mask - 1) {
+                        size_t index = group * GroupSize + lowestBit(mask);
+                        if (KeyOf::get(slots[index]) == key) return index;
+                    }
+                    if (g.matchEmpty() != 0) break;
+                    group = (group + step) & groupMask;
+                }
+                return capacity_;
+            }
+
+            // Returns first empty or deleted slot in probe sequence, table must
+            // have one. Zero capacity is handled by returning 0 (caller grows).
+            size_t findFreeIndex(uint64_t hash) const {
+                if (capacity_ == 0) return 0;
+
+                size_t groupMask = capacity_ / GroupSize - 1;
+                size_t group = firstGroup(hash);
+                for (size_t step = 1; ; ++step) {
+                    uint32_t mask = Group(ctrl + group * GroupSize).matchEmptyOrDeleted();
+                    if (mask != 0) return group * GroupSize + lowestBit(mask);
+                    group = (group + step) & groupMask;
+                }
+            }
+
+            void eraseAt(size_t index) {
+                slots[index].~Value();
+                --size_;
+
+                const int8_t* groupStart = ctrl + index / GroupSize * GroupSize;
+                if (Group(groupStart).matchEmpty() != 0) {
+                    ctrl[index] = CtrlEmpty;
+                    ++growthLeft;
+                } else {
+                    ctrl[index] = CtrlDeleted;
+                }
+            }
+
+            void rehash(size_t newCapacity) {
+                SnowflakeTable other;
+                other.allocate(newCapacity);
+                for (size_t i = 0; i < capacity_; ++i) {
+                    if (ctrl[i] < 0) continue;
+
+                    uint64_t hash = KeyOf::get(slots[i]).hash();
+                    size_t index = other.findFreeIndex(hash);
+                    new (other.slots + index) Value(std::move(slots[i]));
+                    other.ctrl[index] = h2(hash);
+                    ++other.size_;
+                    --other.growthLeft;
+                }
+                swap(other);
+            }
+
+            // Slots and control bytes share one allocation, slots first to
+            // keep them aligned.
+            void allocate(size_t capacity) {
+                static_assert(alignof(Value) <= alignof(std::max_align_t), "Over-aligned values are not supported.");
+
+                void* memory = ::operator new(capacity * (sizeof(Value) + 1));
+                slots = static_cast<Value*>(memory);
+                ctrl = reinterpret_cast<int8_t*>(slots + capacity);
+                std::memset(ctrl, CtrlEmpty, capacity);
+                capacity_ = capacity;
+                growthLeft = maxLoad(capacity);
+            }
+
+            void destroy() {
+                if (capacity_ == 0) return;
+                for (size_t i = 0; i < capacity_; ++i) {
+                    if (ctrl[i] >= 0) slots[i].~Value();
+                }
+                ::operator delete(static_cast<void*>(slots));
+            }
+
+            Value*  slots      = nullptr;
+            int8_t* ctrl       = nullptr;
+            size_t  capacity_  = 0;
+            size_t  size_      = 0;
+            size_t  growthLeft = 0;
+        };
+    } // namespace _Detail
+
+    /**
+     * Flat map from snowflake to \p T.
+     *
+     * Interface is subset of std::unordered_map. Elements are pair<const
+     * Snowflake, T>, so code written for std::map usually works unchanged.
+     */
+    template<typename T>
+    class SnowflakeMap : public _Detail::SnowflakeTable<std::pair<const Snowflake, T>, _Detail::MapKeyOf, true> {
+        using Table = _Detail::SnowflakeTable<std::pair<const Snowflake, T>, _Detail::MapKeyOf, true>;
+    public:
+        using mapped_type = T;
+        using typename Table::iterator;
+        using typename Table::value_type;
+
+        /**
+         * Inserts value constructed from \p args if there is no element with
+         * \p key, otherwise does nothing (args are not moved from).
+         */
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Snowflake key, Args&&... args) {
+            return this->emplaceKey(key, std::piecewise_construct,
+                                    std::forward_as_tuple(key),
+                                    std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value) {
+            return this->emplaceKey(value.first, value);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value) {
+            return this->emplaceKey(value.first, std::move(value));
+        }
+
+        T& operator[](Snowflake key) {
+            return emplace(key).first->second;
+        }
+
+        /// \throws std::out_of_range If there is no element with \p key.
+        T& at(Snowflake key) {
+            auto it = this->find(key);
+            if (it == this->end()) throw std::out_of_range("SnowflakeMap::at: no such key");
+            return it->second;
+        }
+
+        /// \throws std::out_of_range If there is no element with \p key.
+        const T& at(Snowflake key) const {
+            auto it = this->find(key);
+            if (it == this->end()) throw std::out_of_range("SnowflakeMap::at: no such key");
+            return it->second;
+        }
+    };
+
+    /**
+     * Flat set of snowflakes.
+     */
+    class SnowflakeSet : public _Detail::SnowflakeTable<Snowflake, _Detail::SetKeyOf, false> {
+    public:
+        std::pair<iterator, bool> insert(Snowflake key) {
+            return emplaceKey(key, key);
+        }
+    };
+} // namespace Hexicord
+
+#undef HEXICORD_SNOWFLAKE_MAP_SSE2
+
+#endif // HEXICORD_SNOWFLAKE_MAP_HPP
@@ -3,33 +3,180 @@
 #include <iterator>                    // std::istreambuf_iterator
 #include <algorithm>                   // std::copy
 #include <fstream>                     // std::ifstream
+#include <memory>                      // std::shared_ptr
+#include <mutex>                       // std::mutex
+#include <stdexcept>                   // std::runtime_error
+#include <utility>                     // std::move
 #include "hexicord/internal/utils.hpp" // Utils::split
 
 #if _WIN32
     #define PATH_DELIMITER '\\'
 #elif !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__)))
     #define PATH_DELIMITER '/'
+    #define HEXICORD_HAVE_MMAP
+
+    #include <fcntl.h>                 // open
+    #include <sys/mman.h>              // mmap, munmap
+    #include <sys/stat.h>              // fstat
+    #include <unistd.h>                // read, close
+    #include <cerrno>                  // errno
 #endif
 
 namespace Hexicord {
 
+namespace {
+#ifdef HEXICORD_HAVE_MMAP
+    struct Mapping {
+        Mapping(void* address, size_t size) : address(address), size(size) {}
+        ~Mapping() { munmap(address, size); }
+
+        void* const address;
+        const size_t size;
+    };
+
+    struct FileDescriptor {
+        explicit FileDescriptor(int fd) : fd(fd) {}
+        ~FileDescriptor() { if (fd >= 0) ::close(fd); }
+
+        const int fd;
+    };
+#endif
+} // namespace
+
 File::File(const std::string& path)
-    : filename(Utils::split(path, PATH_DELIMITER).back())
-    , bytes(std::istreambuf_iterator<char>(std::ifstream(path, std::ios_base::binary).rdbuf()),
-            std::istreambuf_iterator<char>()) {}
+    : filename(Utils::split(path, PATH_DELIMITER).back()) {
+
+#ifdef HEXICORD_HAVE_MMAP
+    FileDescriptor file(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (file.fd < 0) throw std::runtime_error(std::string("Failed to open file: ") + path);
+
+    struct stat info;
+    if (fstat(file.fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        size_t size = size_t(info.st_size);
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+        if (address != MAP_FAILED) {
+            // Mapping stays valid after descriptor is closed.
+            contents = std::make_shared<const Mapping>(address, size);
+            pointer  = static_cast<const uint8_t*>(address);
+            length   = size;
+            return;
+        }
+    }
+
+    // Not a regular file (pipe, character device) or mmap failed, read it.
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[64 * 1024];
+    while (true) {
+        ssize_t read = ::read(file.fd, chunk, sizeof(chunk));
+        if (read < 0 && errno == EINTR) continue;
+        if (read < 0) throw std::runtime_error(std::string("Failed to read file: ") + path);
+        if (read == 0) break;
+
+        bytes.insert(bytes.end(), chunk, chunk + read);
+    }
+    setContents(std::move(bytes));
+#else
+    std::ifstream stream(path, std::ios_base::binary);
+    if (!stream) throw std::runtime_error(std::string("Failed to open file: ") + path);
+
+    setContents(std::vector<uint8_t>(std::istreambuf_iterator<char>(stream.rdbuf()),
+                                     std::istreambuf_iterator<char>()));
+#endif
+}
 
 File::File(const std::string& filename, std::istream&& stream)
-    : filename(filename)
-    , bytes(std::istreambuf_iterator<char>(stream.rdbuf()),
-            std::istreambuf_iterator<char>()) {}
+    : filename(filename) {
+
+    setContents(std::vector<uint8_t>(std::istreambuf_iterator<char>(stream.rdbuf()),
+                                     std::istreambuf_iterator<char>()));
+}
 
 File::File(const std::string& filename, const std::vector<uint8_t>& bytes)
+    : filename(filename) {
+
+    setContents(std::vector<uint8_t>(bytes));
+}
+
+File::File(const std::string& filename, std::vector<uint8_t>&& bytes)
+    : filename(filename) {
+
+    setContents(std::move(bytes));
+}
+
+File::File(const std::string& filename, uint64_t size, Reader reader)
     : filename(filename)
-    , bytes(bytes) {}
+    , reader(std::move(reader))
+    , length(size) {}
+
+File File::stream(const std::string& path) {
+    struct Source {
+        std::mutex mutex;
+        std::ifstream stream;
+    };
+
+    const std::string filename = Utils::split(path, PATH_DELIMITER).back();
+
+    auto source = std::make_shared<Source>();
+    source->stream.open(path, std::ios_base::binary);
+    if (!source->stream) throw std::runtime_error(std::string("Failed to open file: ") + path);
+
+    source->stream.seekg(0, std::ios_base::end);
+    const std::streamoff end = source->stream.tellg();
+    if (end < 0) {
+        // Not seekable (pipe, FIFO), reader can't jump to offset, so read
+        // it now. Nothing was consumed by failed seek.
+        source->stream.clear();
+        return File(filename, std::move(source->stream));
+    }
+
+    return File(filename, uint64_t(end),
+                [source](uint64_t offset, uint8_t* buffer, size_t count) -> size_t {
+        std::lock_guard<std::mutex> lock(source->mutex);
+
+        source->stream.clear();
+        source->stream.seekg(std::streamoff(offset));
+        source->stream.read(reinterpret_cast<char*>(buffer), std::streamsize(count));
+        return size_t(source->stream.gcount());
+    });
+}
+
+void File::setContents(std::vector<uint8_t>&& bytes) {
+    auto owned = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+    pointer  = owned->data();
+    length   = owned->size();
+    contents = std::move(owned);
+}
 
 void File::write(const std::string& targetPath) const {
     std::ofstream output(targetPath, std::ios_base::binary | std::ios_base::trunc);
-    std::copy(bytes.begin(), bytes.end(), std::ostreambuf_iterator<char>(output.rdbuf()));
+    if (!isStreamed()) {
+        output.write(reinterpret_cast<const char*>(pointer), std::streamsize(length));
+        return;
+    }
+
+    std::vector<uint8_t> chunk(64 * 1024);
+    for (uint64_t offset = 0; offset < length;) {
+        size_t read = reader(offset, chunk.data(), chunk.size());
+        if (read == 0) break;
+
+        output.write(reinterpret_cast<const char*>(chunk.data()), std::streamsize(read));
+        offset += read;
+    }
+}
+
+std::vector<uint8_t> File::readAll() const {
+    if (!isStreamed()) return std::vector<uint8_t>(pointer, pointer + length);
+
+    std::vector<uint8_t> result(static_cast<size_t>(length));
+    for (uint64_t offset = 0; offset < length;) {
+        size_t read = reader(offset, result.data() + offset, size_t(length - offset));
+        if (read == 0) {
+            result.resize(size_t(offset));
+            break;
+        }
+        offset += read;
+    }
+    return result;
 }
 
 } // namespace Hexicord
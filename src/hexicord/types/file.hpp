@@ -1,24 +1,54 @@
 #ifndef HEXICORD_TYPES_FILE_HPP
 #define HEXICORD_TYPES_FILE_HPP
 
-#include <cstdint>  // uint8_t
-#include <string>   // std::string
-#include <vector>   // std::vector
-#include <iosfwd>   // std::istream
+#include <cstdint>     // uint8_t, uint64_t
+#include <cstddef>     // size_t
+#include <functional>  // std::function
+#include <memory>      // std::shared_ptr
+#include <string>      // std::string
+#include <vector>      // std::vector
+#include <iosfwd>      // std::istream
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define HEXICORD_DEPRECATED __attribute__((deprecated))
+#elif defined(_MSC_VER)
+    #define HEXICORD_DEPRECATED __declspec(deprecated)
+#else
+    #define HEXICORD_DEPRECATED
+#endif
 
 namespace Hexicord {
     /**
      * Struct for (filename, bytes) pair.
+     *
+     * Contents is shared between copies, so File is cheap to copy.
+     *
+     * \note Public `bytes` member was replaced by \ref data and \ref size
+     *       (or \ref readAll), deprecated \ref bytes() is kept for
+     *       compatibility. File(const std::string&) now throws
+     *       std::runtime_error if file can't be opened or read, instead
+     *       of producing File with empty contents.
      */
     struct File {
         /**
-         * Read file specified by `path` to \ref bytes.
-         * Last component of path used as filename.
+         * Function used to read contents of streamed file, should read at
+         * most size bytes starting at offset and return count of bytes read.
+         */
+        using Reader = std::function<size_t(uint64_t offset, uint8_t* buffer, size_t size)>;
+
+        /**
+         * Open file specified by `path`. Last component of path used as filename.
+         *
+         * Regular files are memory-mapped where supported, so contents is
+         * not copied and is loaded by OS on demand. Other files (like pipes)
+         * are read until EOF.
+         *
+         * \throws std::runtime_error if file can't be opened.
          */
         File(const std::string& path);
 
         /**
-         * Read stream until EOF to \ref bytes.
+         * Read stream until EOF.
          */
         File(const std::string& filename, std::istream&& stream);
 
@@ -27,13 +57,70 @@ namespace Hexicord {
          */
         File(const std::string& filename, const std::vector<uint8_t>& bytes);
 
+        /**
+         * Use passed vector as file contents.
+         */
+        File(const std::string& filename, std::vector<uint8_t>&& bytes);
+
+        /**
+         * Don't load contents to memory, read it using reader when needed.
+         * Sent files are streamed to socket in small chunks.
+         *
+         * \ref data returns nullptr for such files.
+         */
+        File(const std::string& filename, uint64_t size, Reader reader);
+
+        /**
+         * Open file specified by `path` as streamed file. Last component
+         * of path used as filename.
+         *
+         * Files that can't be seeked (pipes, FIFOs) are read into memory
+         * instead, like \ref File(const std::string&) does.
+         *
+         * \throws std::runtime_error if file can't be opened.
+         */
+        static File stream(const std::string& path);
+
         /**
          * Helper function, write file to std::ofstream(targetPath).
          */
         void write(const std::string& targetPath) const;
 
+        /**
+         * Read whole contents into vector, works for streamed files too.
+         */
+        std::vector<uint8_t> readAll() const;
+
+        /**
+         * Copy of whole contents, same as \ref readAll.
+         *
+         * \deprecated Copies contents on every call, use \ref data and
+         *             \ref size or \ref readAll instead.
+         */
+        HEXICORD_DEPRECATED inline std::vector<uint8_t> bytes() const { return readAll(); }
+
+        /// Whether contents is read by \ref reader instead of stored in memory.
+        inline bool isStreamed() const { return bool(reader); }
+
+        /// Size of file contents in bytes.
+        inline uint64_t size() const { return length; }
+
+        /// Pointer to file contents, nullptr for streamed files.
+        inline const uint8_t* data() const { return pointer; }
+
+        /// Object that owns memory pointed by \ref data, data stays valid
+        /// while it (or any File copy) exists.
+        inline const std::shared_ptr<const void>& storage() const { return contents; }
+
         const std::string filename;
-        const std::vector<uint8_t> bytes;
+
+        const Reader reader;
+    private:
+        void setContents(std::vector<uint8_t>&& bytes);
+
+        std::shared_ptr<const void> contents;
+        const uint8_t* pointer = nullptr;
+        uint64_t length = 0;
     };
 } // namespace Hexicord
 
@@ -1,9 +1,11 @@
 #include "hexicord/types/image.hpp"
 
+#include <algorithm>                   // std::min
+#include <cstring>                     // std::strlen
 #include <boost/asio/io_service.hpp>   // boost::asio::io_service
 #include "hexicord/internal/utils.hpp" // Hexicord::Utils::Magic, Hexicord::Utils::base64Encode
 #include "hexicord/exceptions.hpp"     // Hexicord::LogicError
-#include "hexicord/internal/rest.hpp"  // Hexicord::REST
+#include "hexicord/cdn_client.hpp"     // Hexicord::CdnClient
 
 namespace Hexicord {
 
@@ -13,43 +15,79 @@ Image::Image(const File& file, ImageFormat format)
 {}
 
 std::string Image::toAvatarData() const {
-    std::string mimeType;
+    const char* mimeType = "";
     if (format == Jpeg) mimeType = "image/jpeg";
     if (format == Png)  mimeType = "image/png";
     if (format == Webp) mimeType = "image/webp";
     if (format == Gif)  mimeType = "image/gif";
 
-    return std::string("data:") + mimeType + ";base64," + Utils::base64Encode(file.bytes);
+    const size_t size = size_t(file.size());
+
+    // Whole data URI is allocated once and base64 is written right into it.
+    std::string result;
+    result.reserve(std::strlen("data:") + std::strlen(mimeType) + std::strlen(";base64,") + Utils::base64EncodedSize(size));
+    result.append("data:").append(mimeType).append(";base64,");
+
+    size_t offset = result.size();
+    result.resize(offset + Utils::base64EncodedSize(size));
+
+    if (!file.isStreamed()) {
+        Utils::base64Encode(file.data(), size, &result[offset]);
+        return result;
+    }
+
+    // Streamed file is encoded chunk by chunk instead of reading it into
+    // memory first. Chunk size is multiple of 3 so padding appears only at end.
+    uint8_t chunk[3 * 4096];
+    uint64_t position = 0;
+    while (position < size) {
+        size_t filled = 0;
+        size_t wanted = std::min(sizeof(chunk), size_t(size - position));
+        while (filled < wanted) {
+            size_t read = file.reader(position + filled, chunk + filled, wanted - filled);
+            if (read == 0) break;
+            filled += read;
+        }
+
+        Utils::base64Encode(chunk, filled, &result[offset]);
+        offset   += Utils::base64EncodedSize(filled);
+        position += filled;
+
+        // File is shorter than declared, same as File::readAll use what we got.
+        if (filled < wanted) {
+            result.resize(offset);
+            break;
+        }
+    }
+    return result;
 }
 
 ImageFormat Image::detectFormat(const File& file) {
-    if (Utils::Magic::isJfif(file.bytes)) return ImageFormat::Jpeg;
-    if (Utils::Magic::isPng(file.bytes))  return ImageFormat::Png;
-    if (Utils::Magic::isWebp(file.bytes)) return ImageFormat::Webp;
-    if (Utils::Magic::isGif(file.bytes))  return ImageFormat::Gif;
+    const uint8_t* data = file.data();
+    size_t size = size_t(file.size());
+
+    // Only first bytes are needed.
+    uint8_t header[12];
+    if (file.isStreamed()) {
+        size = file.reader(0, header, std::min(sizeof(header), size));
+        data = header;
+    }
+
+    if (Utils::Magic::isJfif(data, size)) return ImageFormat::Jpeg;
+    if (Utils::Magic::isPng(data, size))  return ImageFormat::Png;
+    if (Utils::Magic::isWebp(data, size)) return ImageFormat::Webp;
+    if (Utils::Magic::isGif(data, size))  return ImageFormat::Gif;
 
     throw LogicError("Failed to detect image format.", -1);
 }
 
 namespace _Detail {
-    std::vector<uint8_t> cdnDownload(boost::asio::io_service& ioService, const std::string& path) {
-        REST::HTTPSConnection connection(ioService, "cdn.discordapp.com");
-        connection.open();
-
-        REST::HTTPRequest request;
-        request.method  = "GET";
-        request.path    = path;
-        request.version = 11;
-
-        REST::HTTPResponse response = connection.request(request);
-        if (response.body.empty()) {
-            throw LogicError("Response body is empty (are you trying to download non-animated avatar as GIF?)", -1);
-        }
-        if (response.statusCode != 200) {
-            throw LogicError(std::string("HTTP status code: ") + std::to_string(response.statusCode), -1);
-        }
+    File cdnDownload(boost::asio::io_service& ioService, const std::string& path) {
+        return CdnClient::forService(ioService).downloadFile(path);
+    }
 
-        return response.body;
+    File cdnDownload(CdnClient& client, const std::string& path) {
+        return client.downloadFile(path);
     }
 } // namespace _Detail
 
@@ -8,6 +8,7 @@
 #include "hexicord/types/snowflake.hpp"
 #include "hexicord/types/file.hpp"
 namespace boost { namespace asio { class io_service; }}
+namespace Hexicord { class CdnClient; }
 
 namespace Hexicord {
 
@@ -65,7 +66,8 @@ namespace Hexicord {
      * Implementation details. Probably not what you looking for.
      */
     namespace _Detail {
-        std::vector<uint8_t> cdnDownload(boost::asio::io_service& ioService, const std::string& path);
+        File cdnDownload(boost::asio::io_service& ioService, const std::string& path);
+        File cdnDownload(CdnClient& client, const std::string& path);
 
         inline constexpr bool isPowerOfTwo(unsigned number) {
             return ((number != 0) && ((number & (~number + 1)) == number));
@@ -135,7 +137,7 @@ namespace Hexicord {
         }
 
         /**
-         * Download this image. ioService used to construct HTTP connection object.
+         * Download this image using CdnClient shared by users of ioService.
          * size can be power of two between 16 and 2048.
          *
          * May throw LogicError if body is empty (see \ref isAnimated()) and
@@ -146,9 +148,18 @@ namespace Hexicord {
             static_assert(_Detail::isSupportedFormat(Type, Format), "Format is not supported for this image type.");
             if (!_Detail::isPowerOfTwo(size)) throw LogicError("Image size must be power of two.", -1);
 
-            return Image(File(hash + "." + _Detail::formatExtension<Format>(),
-                              _Detail::cdnDownload(ioService, url<Format>(size))),
-                         Format);
+            return Image(_Detail::cdnDownload(ioService, url<Format>(size)), Format);
+        }
+
+        /**
+         * Download this image using specified CdnClient.
+         */
+        template<ImageFormat Format>
+        inline Image download(CdnClient& client, unsigned short size) const {
+            static_assert(_Detail::isSupportedFormat(Type, Format), "Format is not supported for this image type.");
+            if (!_Detail::isPowerOfTwo(size)) throw LogicError("Image size must be power of two.", -1);
+
+            return Image(_Detail::cdnDownload(client, url<Format>(size)), Format);
         }
 
         const Snowflake id;
@@ -195,7 +206,7 @@ namespace Hexicord {
         }
 
         /**
-         * Download this image. ioService used to construct HTTP connection object.
+         * Download this image using CdnClient shared by users of ioService.
          * size can be power of two between 16 and 2048.
          *
          * May throw LogicError if body is empty (see \ref isAnimated()) and
@@ -203,9 +214,15 @@ namespace Hexicord {
          */
         template<ImageFormat Format>
         inline Image download(boost::asio::io_service& ioService, unsigned short size) const {
-            return Image(File(hash + "." + _Detail::formatExtension<Format>(),
-                              _Detail::cdnDownload(ioService, url<Format>(size))),
-                         Format);
+            return Image(_Detail::cdnDownload(ioService, url<Format>(size)), Format);
+        }
+
+        /**
+         * Download this image using specified CdnClient.
+         */
+        template<ImageFormat Format>
+        inline Image download(CdnClient& client, unsigned short size) const {
+            return Image(_Detail::cdnDownload(client, url<Format>(size)), Format);
         }
 
         const std::string hash;
@@ -247,7 +264,7 @@ namespace Hexicord {
         }
 
         /**
-         * Download this image. ioService used to construct HTTP connection object.
+         * Download this image using CdnClient shared by users of ioService.
          * size can be power of two between 16 and 2048.
          *
          * May throw LogicError if body is empty (see \ref isAnimated()) and
@@ -258,9 +275,18 @@ namespace Hexicord {
             static_assert(_Detail::isSupportedFormat(CustomEmoji, Format), "Format is not supported for this image type.");
             if (!_Detail::isPowerOfTwo(size)) throw LogicError("Image size must be power of two.", -1);
 
-            return Image(File(std::to_string(userDiscriminator % 5) + "." + _Detail::formatExtension<Format>(),
-                              _Detail::cdnDownload(ioService, url<Format>(size))),
-                         Format);
+            return Image(_Detail::cdnDownload(ioService, url<Format>(size)), Format);
+        }
+
+        /**
+         * Download this image using specified CdnClient.
+         */
+        template<ImageFormat Format>
+        inline Image download(CdnClient& client, unsigned short size) const {
+            static_assert(_Detail::isSupportedFormat(CustomEmoji, Format), "Format is not supported for this image type.");
+            if (!_Detail::isPowerOfTwo(size)) throw LogicError("Image size must be power of two.", -1);
+
+            return Image(_Detail::cdnDownload(client, url<Format>(size)), Format);
         }
 
         const int userDiscriminator;
@@ -2,12 +2,17 @@
 #define HEXICORD_TYPES_SNOWFLAKE_HPP
 
 #include <cstdint>                     // uint64_t
+#include <ctime>                       // time_t
 #include <string>                      // std::string
 #include <vector>                      // std::vector
 #include <functional>                  // std::hash
 #include "hexicord/json.hpp"           // nlohmann::json
 
 namespace Hexicord {
+    namespace _Detail {
+        constexpr uint64_t xorShift33(uint64_t value) { return value ^ (value >> 33); }
+    } // namespace _Detail
+
     struct Snowflake {
         constexpr Snowflake() : value(0) {}
         constexpr Snowflake(uint64_t value) : value(value) {}
@@ -28,14 +33,40 @@ namespace Hexicord {
 
         static constexpr uint64_t discordEpochMs = 1420070400000;
 
+        /**
+         * Smallest snowflake with specified timestamp (milliseconds since
+         * Unix epoch). Can be used as a bound for time ranges, for example
+         * with \ref RestClient::getMessages or \ref SnowflakeIndex.
+         *
+         * Timestamps before Discord epoch give 0.
+         */
+        static inline constexpr Snowflake fromUnixTimestampMs(uint64_t timestampMs) {
+            return timestampMs <= discordEpochMs ? Snowflake() : Snowflake((timestampMs - discordEpochMs) << 22);
+        }
+
+        /// Same as \ref fromUnixTimestampMs, but with timestamp in seconds.
+        static inline constexpr Snowflake fromUnixTimestamp(time_t timestamp) {
+            return fromUnixTimestampMs(uint64_t(timestamp) * 1000);
+        }
+
         inline constexpr time_t unixTimestamp() const {
-            return this->parts.timestamp + discordEpochMs / 1000;
+            return time_t((this->parts.timestamp + discordEpochMs) / 1000);
         }
 
         inline constexpr unsigned long long unixTimestampMs() const {
             return this->parts.timestamp + discordEpochMs;
         }
 
+        /**
+         * Mixed hash of snowflake value (murmur3 finalizer).
+         *
+         * Raw value is a bad hash: low bits are increment and process/worker
+         * IDs, so tables indexed by low bits (power-of-two sizes) cluster.
+         */
+        inline constexpr uint64_t hash() const {
+            return _Detail::xorShift33(_Detail::xorShift33(_Detail::xorShift33(value) * 0xff51afd7ed558ccdULL) * 0xc4ceb9fe1a85ec53ULL);
+        }
+
         inline constexpr operator uint64_t() const { return value; }
     };
 
@@ -44,7 +75,12 @@ namespace Hexicord {
     }
 
     inline void from_json(const nlohmann::json& json, Snowflake& snowflake) {
-        snowflake.value = json.get<uint64_t>();
+        // Discord sends snowflakes as strings to not lose precision in JS.
+        if (json.is_string()) {
+            snowflake = Snowflake(json.get_ref<const std::string&>());
+        } else {
+            snowflake.value = json.get<uint64_t>();
+        }
     }
 } // namespace Hexicord
 
@@ -53,7 +89,7 @@ namespace std {
     struct hash<Hexicord::Snowflake> {
     public:
         constexpr inline size_t operator()(const Hexicord::Snowflake& snowflake) const {
-            return static_cast<uint64_t>(snowflake);
+            return static_cast<size_t>(snowflake.hash());
         }
     };
 }
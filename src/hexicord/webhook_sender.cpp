@@ -0,0 +1,106 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "hexicord/webhook_sender.hpp"
+
+#include <atomic>                               // std::atomic
+#include "hexicord/exceptions.hpp"              // Hexicord::LogicError
+#include "hexicord/internal/worker_pool.hpp"    // Hexicord::WorkerPool
+
+namespace Hexicord {
+    struct WebhookSlot {
+        WebhookSlot(boost::asio::io_service& ioService, const WebhookSender::Webhook& webhook,
+                    const std::string& serverName, unsigned short port, bool tls)
+            : webhook(webhook)
+            , client(ioService, "", 1, serverName, port, tls)
+            , worker(1) {}
+
+        const WebhookSender::Webhook webhook;
+
+        // Executing webhooks doesn't requires authorization.
+        RestClient client;
+
+        std::atomic<unsigned> pending { 0 };
+
+        // Declared last, so queued messages are sent before client is destroyed.
+        WorkerPool worker;
+    };
+
+    WebhookSender::WebhookSender(boost::asio::io_service& ioService, const std::vector<Webhook>& webhooks,
+                                 const std::string& serverName, unsigned short port, bool tls) {
+        if (webhooks.empty()) throw LogicError("No webhooks passed to WebhookSender.", -1);
+
+        slots.reserve(webhooks.size());
+        for (const Webhook& webhook : webhooks) {
+            slots.push_back(std::make_shared<WebhookSlot>(ioService, webhook, serverName, port, tls));
+        }
+    }
+
+    WebhookSender WebhookSender::forChannel(boost::asio::io_service& ioService, RestClient& client, Snowflake channelId,
+                                            const std::string& serverName, unsigned short port, bool tls) {
+        std::vector<Webhook> webhooks;
+        for (const nlohmann::json& webhook : client.getChannelWebhooks(channelId)) {
+            if (webhook.find("token") == webhook.end() || !webhook["token"].is_string()) continue;
+
+            webhooks.push_back({ webhook["id"].get<Snowflake>(), webhook["token"].get<std::string>() });
+        }
+        if (webhooks.empty()) throw LogicError("Channel has no webhooks with token.", -1);
+
+        return WebhookSender(ioService, webhooks, serverName, port, tls);
+    }
+
+    std::future<nlohmann::json> WebhookSender::send(const std::string& text,
+                                                    const nlohmann::json& embeds,
+                                                    const boost::optional<File>& file,
+                                                    const std::string& username,
+                                                    const std::string& avatarUrl) {
+
+        // Webhook that waits for ratelimit reset has longer queue, so
+        // messages go to other ones meanwhile.
+        std::shared_ptr<WebhookSlot> slot = slots.front();
+        for (const std::shared_ptr<WebhookSlot>& candidate : slots) {
+            if (candidate->pending < slot->pending) slot = candidate;
+        }
+
+        auto promise = std::make_shared<std::promise<nlohmann::json>>();
+        std::future<nlohmann::json> result = promise->get_future();
+
+        ++slot->pending;
+        WebhookSlot* rawSlot = slot.get();
+        slot->worker.post([rawSlot, promise, text, embeds, file, username, avatarUrl]() {
+            try {
+                promise->set_value(rawSlot->client.executeWebhook(rawSlot->webhook.id, rawSlot->webhook.token,
+                                                                  text, embeds, file, username, avatarUrl));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+            --rawSlot->pending;
+        });
+        return result;
+    }
+
+    unsigned WebhookSender::pending() const {
+        unsigned result = 0;
+        for (const std::shared_ptr<WebhookSlot>& slot : slots) result += slot->pending;
+        return result;
+    }
+} // namespace Hexicord
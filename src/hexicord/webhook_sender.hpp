@@ -0,0 +1,114 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef HEXICORD_WEBHOOK_SENDER_HPP
+#define HEXICORD_WEBHOOK_SENDER_HPP
+
+#include <future>                        // std::future
+#include <memory>                        // std::shared_ptr
+#include <string>                        // std::string
+#include <vector>                        // std::vector
+#include <boost/optional.hpp>            // boost::optional
+#include "hexicord/json.hpp"             // nlohmann::json
+#include "hexicord/rest_client.hpp"      // Hexicord::RestClient
+#include "hexicord/types.hpp"            // Hexicord::Snowflake, Hexicord::File
+namespace boost { namespace asio { class io_service; }}
+
+namespace Hexicord {
+    struct WebhookSlot;
+
+    /**
+     * Sends messages through pool of webhooks.
+     *
+     * Every webhook has own ratelimit bucket, separate from bot's
+     * per-channel bucket, so N webhooks in same channel give roughly N
+     * times more messages per second. Each webhook gets own connection and
+     * sending thread, message is queued to webhook with fewest pending
+     * messages.
+     *
+     * ```cpp
+     * Hexicord::WebhookSender sender = Hexicord::WebhookSender::forChannel(ioService, rclient, logChannel);
+     * sender.send("Something happened");
+     * ```
+     *
+     * \note Messages sent through different webhooks may appear in
+     *       channel out of order.
+     *
+     * All methods are thread-safe.
+     */
+    class WebhookSender {
+    public:
+        struct Webhook {
+            Snowflake id;
+            std::string token;
+        };
+
+        /**
+         * \param ioService  ASIO I/O service. Should not be destroyed while
+         *                   WebhookSender exists.
+         * \param webhooks   Webhooks to use, at least one.
+         * \param serverName Host to send requests to, see \ref RestClient::RestClient.
+         * \param port       Server port.
+         * \param tls        Use HTTPS, plain HTTP is used if false.
+         */
+        WebhookSender(boost::asio::io_service& ioService, const std::vector<Webhook>& webhooks,
+                      const std::string& serverName = "discordapp.com", unsigned short port = 443, bool tls = true);
+
+        /**
+         * Use all webhooks of channel that have token (i.e. created by
+         * same user, see \ref RestClient::createWebhook).
+         *
+         * \param client Used to get webhooks list only.
+         *
+         * Other parameters are same as in constructor, pass same values
+         * as to client.
+         *
+         * \throws LogicError if channel has no usable webhooks.
+         */
+        static WebhookSender forChannel(boost::asio::io_service& ioService, RestClient& client, Snowflake channelId,
+                                        const std::string& serverName = "discordapp.com", unsigned short port = 443,
+                                        bool tls = true);
+
+        /**
+         * Queue message, see \ref RestClient::executeWebhook for parameters.
+         * Future receives created message object or exception.
+         */
+        std::future<nlohmann::json> send(const std::string& text,
+                                         const nlohmann::json& embeds = nullptr,
+                                         const boost::optional<File>& file = boost::none,
+                                         const std::string& username = "",
+                                         const std::string& avatarUrl = "");
+
+        /// Count of messages queued but not sent yet.
+        unsigned pending() const;
+
+        /// Count of webhooks in pool.
+        size_t size() const { return slots.size(); }
+
+    private:
+        // Slots are destroyed (and queued messages sent) when last copy
+        // of sender is destroyed.
+        std::vector<std::shared_ptr<WebhookSlot>> slots;
+    };
+} // namespace Hexicord
+
+#endif // HEXICORD_WEBHOOK_SENDER_HPP
@@ -0,0 +1,517 @@
+// Hexicord - Discord API library for C++11 using boost libraries.
+// Copyright © 2017 Maks Mazurov (fox.cpp) <foxcpp@yandex.ru>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Minimal in-memory imitation of Discord REST API.
+//
+// Speaks plain HTTP/1.1 (use RestClient(ioService, token, n, "localhost", port, false))
+// and emulates per-route buckets (X-RateLimit-* headers), global rate limit and
+// 429 responses so ratelimiting and retry logic can be tested and benchmarked
+// without touching real Discord.
+
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <hexicord/json.hpp>
+#include <hexicord/types.hpp>
+
+namespace http = boost::beast::http;
+using     tcp  = boost::asio::ip::tcp;
+
+struct Options {
+    unsigned short port          = 8080;
+    unsigned       bucketLimit   = 5;
+    unsigned       bucketWindowMs = 5000;
+    unsigned       globalLimit   = 50; // per second, 0 disables global limit.
+    bool           verbose       = false;
+};
+
+static uint64_t epochMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+class RateLimiter {
+public:
+    explicit RateLimiter(const Options& options) : options(options) {}
+
+    struct Decision {
+        bool allowed;
+        bool global;
+        unsigned limit;
+        unsigned remaining;
+        uint64_t resetMs;      // epoch ms
+        uint64_t retryAfterMs;
+    };
+
+    Decision acquire(const std::string& bucketKey) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t now = epochMs();
+
+        if (options.globalLimit != 0) {
+            if (now >= globalWindowStart + 1000) {
+                globalWindowStart = now;
+                globalCount = 0;
+            }
+            if (globalCount >= options.globalLimit) {
+                return { false, true, 0, 0, 0, globalWindowStart + 1000 - now };
+            }
+        }
+
+        Bucket& bucket = buckets[bucketKey];
+        if (now >= bucket.resetMs) {
+            bucket.resetMs   = now + options.bucketWindowMs;
+            bucket.remaining = options.bucketLimit;
+        }
+
+        if (bucket.remaining == 0) {
+            return { false, false, options.bucketLimit, 0, bucket.resetMs, bucket.resetMs - now };
+        }
+
+        --bucket.remaining;
+        ++globalCount;
+        return { true, false, options.bucketLimit, bucket.remaining, bucket.resetMs, 0 };
+    }
+
+private:
+    struct Bucket {
+        unsigned remaining = 0;
+        uint64_t resetMs = 0;
+    };
+
+    const Options& options;
+    std::mutex mutex;
+    std::map<std::string, Bucket> buckets;
+    uint64_t globalWindowStart = 0;
+    unsigned globalCount = 0;
+};
+
+class Storage {
+public:
+    nlohmann::json handle(http::verb method, const std::vector<std::string>& path,
+                          const nlohmann::json& payload, http::status& status);
+
+private:
+    Hexicord::Snowflake nextId() {
+        // Use real-looking snowflakes so timestamp extraction on client side works.
+        Hexicord::Snowflake id = Hexicord::Snowflake::fromUnixTimestampMs(epochMs());
+        id.parts.counter   = counter++ & 0xFFF;
+        return id;
+    }
+
+    nlohmann::json& channel(const std::string& id) {
+        auto it = channels.find(id);
+        if (it == channels.end()) {
+            it = channels.emplace(id, nlohmann::json{ { "id", id }, { "type", 0 }, { "name", "mock-" + id } }).first;
+        }
+        return it->second;
+    }
+
+    nlohmann::json& guild(const std::string& id) {
+        auto it = guilds.find(id);
+        if (it == guilds.end()) {
+            it = guilds.emplace(id, nlohmann::json{ { "id", id }, { "name", "mock-" + id }, { "roles", nlohmann::json::array() } }).first;
+        }
+        return it->second;
+    }
+
+    nlohmann::json& member(const std::string& guildId, const std::string& userId) {
+        auto& slot = members[guildId][userId];
+        if (slot.is_null()) {
+            slot = { { "user", user(userId) }, { "roles", nlohmann::json::array() }, { "nick", nullptr } };
+        }
+        return slot;
+    }
+
+    static nlohmann::json user(const std::string& id) {
+        return { { "id", id }, { "username", "mock-user" }, { "discriminator", "0000" }, { "avatar", nullptr } };
+    }
+
+    static nlohmann::json notFound() {
+        return { { "code", 10003 }, { "message", "Unknown Object" } };
+    }
+
+    nlohmann::json createMessage(const std::string& channelId, const nlohmann::json& payload, const nlohmann::json& author) {
+        nlohmann::json message = {
+            { "id",         std::to_string(nextId()) },
+            { "channel_id", channelId },
+            { "author",     author },
+            { "content",    payload.value("content", std::string()) },
+            { "embeds",     payload.count("embeds") ? payload["embeds"] :
+                            payload.count("embed")  ? nlohmann::json::array({ payload["embed"] }) :
+                                                      nlohmann::json::array() },
+            { "tts",        payload.value("tts", false) },
+            { "reactions",  nlohmann::json::array() },
+            { "timestamp",  "2017-01-01T00:00:00.000000+00:00" }
+        };
+        messages[channelId][message["id"].get<std::string>()] = message;
+        return message;
+    }
+
+    std::mutex mutex;
+    uint16_t counter = 0;
+    std::map<std::string, nlohmann::json> channels;
+    std::map<std::string, nlohmann::json> guilds;
+    std::map<std::string, std::map<std::string, nlohmann::json> > messages;         // channel -> id -> message
+    std::map<std::string, std::map<std::string, nlohmann::json> > members;          // guild -> user -> member
+};
+
+nlohmann::json Storage::handle(http::verb method, const std::vector<std::string>& path,
+                               const nlohmann::json& payload, http::status& status) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const size_t n = path.size();
+    status = http::status::ok;
+
+    auto is = [&](std::initializer_list<const char*> pattern) {
+        if (pattern.size() != n) return false;
+        size_t i = 0;
+        for (const char* part : pattern) {
+            if (std::strcmp(part, "*") != 0 && path[i] != part) return false;
+            ++i;
+        }
+        return true;
+    };
+
+    // Gateway.
+    if (is({ "gateway" }) && method == http::verb::get) {
+        return { { "url", "wss://localhost" } };
+    }
+    if (is({ "gateway", "bot" }) && method == http::verb::get) {
+        return { { "url", "wss://localhost" }, { "shards", 1 } };
+    }
+
+    // Users.
+    if (is({ "users", "@me" }) && method == http::verb::get) {
+        return user("1");
+    }
+    if (is({ "users", "@me" }) && method == http::verb::patch) {
+        nlohmann::json me = user("1");
+        if (payload.count("username")) me["username"] = payload["username"];
+        return me;
+    }
+    if (is({ "users", "*" }) && method == http::verb::get) {
+        return user(path[1]);
+    }
+
+    // Channels.
+    if (is({ "channels", "*" })) {
+        if (method == http::verb::get) return channel(path[1]);
+        if (method == http::verb::patch || method == http::verb::put) {
+            nlohmann::json& c = channel(path[1]);
+            for (auto it = payload.begin(); it != payload.end(); ++it) c[it.key()] = it.value();
+            return c;
+        }
+        if (method == http::verb::delete_) {
+            nlohmann::json c = channel(path[1]);
+            channels.erase(path[1]);
+            messages.erase(path[1]);
+            return c;
+        }
+    }
+    if (is({ "channels", "*", "typing" }) && method == http::verb::post) {
+        status = http::status::no_content;
+        return nullptr;
+    }
+    if (is({ "channels", "*", "messages" })) {
+        if (method == http::verb::post) return createMessage(path[1], payload, user("1"));
+        if (method == http::verb::get) {
+            nlohmann::json result = nlohmann::json::array();
+            auto& channelMessages = messages[path[1]];
+            for (auto it = channelMessages.rbegin(); it != channelMessages.rend() && result.size() < 50; ++it) {
+                result.push_back(it->second);
+            }
+            return result;
+        }
+    }
+    if (is({ "channels", "*", "messages", "bulk-delete" }) && method == http::verb::post) {
+        for (const auto& id : payload.value("messages", nlohmann::json::array())) {
+            messages[path[1]].erase(id.is_string() ? id.get<std::string>() : std::to_string(id.get<uint64_t>()));
+        }
+        status = http::status::no_content;
+        return nullptr;
+    }
+    if (is({ "channels", "*", "messages", "*" })) {
+        auto& channelMessages = messages[path[1]];
+        auto it = channelMessages.find(path[3]);
+        if (it == channelMessages.end()) {
+            status = http::status::not_found;
+            return notFound();
+        }
+        if (method == http::verb::get) return it->second;
+        if (method == http::verb::patch) {
+            if (payload.count("content")) it->second["content"] = payload["content"];
+            if (payload.count("embed"))   it->second["embeds"]  = nlohmann::json::array({ payload["embed"] });
+            return it->second;
+        }
+        if (method == http::verb::delete_) {
+            channelMessages.erase(it);
+            status = http::status::no_content;
+            return nullptr;
+        }
+    }
+    // .../reactions, .../reactions/{emoji}, .../reactions/{emoji}/{user or @me}
+    if (n >= 5 && n <= 7 && path[0] == "channels" && path[2] == "messages" && path[4] == "reactions") {
+        auto& channelMessages = messages[path[1]];
+        auto it = channelMessages.find(path[3]);
+        if (it == channelMessages.end()) {
+            status = http::status::not_found;
+            return notFound();
+        }
+        nlohmann::json& reactions = it->second["reactions"];
+        if (method == http::verb::put) {
+            if (n == 7) reactions.push_back({ { "emoji", { { "name", path[5] } } }, { "count", 1 }, { "me", true } });
+        } else if (method == http::verb::delete_) {
+            reactions = nlohmann::json::array();
+        } else if (method == http::verb::get) {
+            return nlohmann::json::array({ user("1") });
+        }
+        status = http::status::no_content;
+        return nullptr;
+    }
+
+    // Guilds.
+    if (is({ "guilds", "*" })) {
+        if (method == http::verb::get) return guild(path[1]);
+        if (method == http::verb::patch) {
+            nlohmann::json& g = guild(path[1]);
+            for (auto it = payload.begin(); it != payload.end(); ++it) g[it.key()] = it.value();
+            return g;
+        }
+    }
+    if (is({ "guilds", "*", "members", "*" })) {
+        if (method == http::verb::get) return member(path[1], path[3]);
+        if (method == http::verb::patch) {
+            nlohmann::json& m = member(path[1], path[3]);
+            for (auto it = payload.begin(); it != payload.end(); ++it) m[it.key()] = it.value();
+            status = http::status::no_content;
+            return nullptr;
+        }
+        if (method == http::verb::delete_) {
+            members[path[1]].erase(path[3]);
+            status = http::status::no_content;
+            return nullptr;
+        }
+    }
+    if (is({ "guilds", "*", "members", "*", "roles", "*" })) {
+        nlohmann::json& roles = member(path[1], path[3])["roles"];
+        if (method == http::verb::put) {
+            roles.push_back(path[5]);
+        } else if (method == http::verb::delete_) {
+            nlohmann::json filtered = nlohmann::json::array();
+            for (const auto& role : roles) if (role != path[5]) filtered.push_back(role);
+            roles = filtered;
+        }
+        status = http::status::no_content;
+        return nullptr;
+    }
+    if (is({ "guilds", "*", "roles" })) {
+        nlohmann::json& roles = guild(path[1])["roles"];
+        if (method == http::verb::get) return roles;
+        if (method == http::verb::post) {
+            nlohmann::json role = { { "id", std::to_string(nextId()) }, { "name", payload.value("name", std::string("new role")) },
+                                    { "permissions", payload.value("permissions", 0) }, { "position", roles.size() } };
+            roles.push_back(role);
+            return role;
+        }
+    }
+
+    // Webhooks.
+    if ((is({ "webhooks", "*", "*" }) || is({ "webhooks", "*", "*", "slack" }) || is({ "webhooks", "*", "*", "github" })) &&
+        method == http::verb::post) {
+
+        nlohmann::json author = user(path[1]);
+        author["username"] = payload.value("username", std::string("mock-webhook"));
+        nlohmann::json message = createMessage("0", payload, author);
+        message["webhook_id"] = path[1];
+        return message;
+    }
+
+    status = http::status::not_found;
+    return { { "code", 0 }, { "message", "404: Not Found" } };
+}
+
+// Split "/api/v6/channels/123/messages?limit=5" into { "channels", "123", "messages" }.
+static std::vector<std::string> splitPath(boost::string_view target) {
+    target = target.substr(0, target.find('?'));
+    if (target.starts_with("/api/v6")) target.remove_prefix(7);
+
+    std::vector<std::string> result;
+    while (!target.empty()) {
+        if (target.front() == '/') {
+            target.remove_prefix(1);
+            continue;
+        }
+        size_t end = target.find('/');
+        result.emplace_back(target.substr(0, end).to_string());
+        target.remove_prefix(end == boost::string_view::npos ? target.size() : end);
+    }
+    return result;
+}
+
+static bool isNumber(const std::string& str) {
+    return !str.empty() && str.find_first_not_of("0123456789") == std::string::npos;
+}
+
+// Same grouping as Discord: major parameters (channel, guild, webhook id) stay in
+// bucket key, any other numeric id is replaced by placeholder.
+static std::string bucketKey(http::verb method, const std::vector<std::string>& path) {
+    std::string key = std::string(http::to_string(method)) + ' ';
+    for (size_t i = 0; i < path.size(); ++i) {
+        bool major = i == 1 && (path[0] == "channels" || path[0] == "guilds" || path[0] == "webhooks");
+        key += '/';
+        key += (!major && isNumber(path[i])) ? "{id}" : path[i];
+    }
+    return key;
+}
+
+// Extracts JSON payload from either application/json or multipart/form-data body.
+static nlohmann::json parsePayload(boost::string_view contentType, const std::string& body) {
+    if (body.empty()) return nlohmann::json::object();
+
+    if (contentType.starts_with("multipart/form-data")) {
+        size_t namePos = body.find("name=\"payload_json\"");
+        if (namePos == std::string::npos) return nlohmann::json::object();
+        size_t begin = body.find("\r\n\r\n", namePos);
+        if (begin == std::string::npos) return nlohmann::json::object();
+        begin += 4;
+        size_t end = body.find("\r\n--", begin);
+        nlohmann::json result = nlohmann::json::parse(body.substr(begin, end - begin), nullptr, false);
+        return result.is_discarded() ? nlohmann::json::object() : result;
+    }
+
+    nlohmann::json result = nlohmann::json::parse(body, nullptr, false);
+    return result.is_discarded() ? nlohmann::json::object() : result;
+}
+
+static void serveConnection(tcp::socket socket, const Options& options, RateLimiter& limiter, Storage& storage) {
+    boost::beast::flat_buffer buffer;
+    boost::system::error_code ec;
+
+    while (true) {
+        http::request<http::string_body> request;
+        http::read(socket, buffer, request, ec);
+        if (ec) break;
+
+        http::response<http::string_body> response;
+        response.version = request.version;
+        response.keep_alive(request.keep_alive());
+        response.set(http::field::server, "hexicord-mock-rest-server");
+        response.set(http::field::content_type, "application/json");
+
+        std::vector<std::string> path = splitPath(request.target());
+        std::string key = bucketKey(request.method(), path);
+        RateLimiter::Decision decision = limiter.acquire(key);
+
+        if (!decision.global) {
+            response.set("X-RateLimit-Limit",     std::to_string(decision.limit));
+            response.set("X-RateLimit-Remaining", std::to_string(decision.remaining));
+            // Rounded up so client never retries before bucket actually resets.
+            response.set("X-RateLimit-Reset",     std::to_string((decision.resetMs + 999) / 1000));
+        }
+
+        if (!decision.allowed) {
+            response.result(http::status::too_many_requests);
+            response.set(http::field::retry_after, std::to_string((decision.retryAfterMs + 999) / 1000));
+            if (decision.global) response.set("X-RateLimit-Global", "true");
+            response.body = nlohmann::json{
+                { "message",     "You are being rate limited." },
+                { "retry_after", decision.retryAfterMs },
+                { "global",      decision.global }
+            }.dump();
+        } else {
+            http::status status;
+            nlohmann::json result = storage.handle(request.method(), path,
+                                                   parsePayload(request[http::field::content_type], request.body),
+                                                   status);
+            response.result(status);
+            if (status != http::status::no_content) response.body = result.dump();
+        }
+
+        if (options.verbose) {
+            std::clog << request.method_string() << ' ' << request.target() << " [" << key << "] -> "
+                      << response.result_int() << '\n';
+        }
+
+        response.prepare_payload();
+        http::write(socket, response, ec);
+        if (ec || !response.keep_alive()) break;
+    }
+
+    socket.shutdown(tcp::socket::shutdown_both, ec);
+}
+
+static void printUsage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [options]\n"
+              << "  --port N              Port to listen on (default 8080).\n"
+              << "  --bucket-limit N      Requests per bucket per window (default 5).\n"
+              << "  --bucket-window-ms N  Bucket reset interval (default 5000).\n"
+              << "  --global-limit N      Requests per second for all routes, 0 to disable (default 50).\n"
+              << "  --verbose             Log every request.\n";
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--port" && hasValue) {
+            options.port = static_cast<unsigned short>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--bucket-limit" && hasValue) {
+            options.bucketLimit = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--bucket-window-ms" && hasValue) {
+            options.bucketWindowMs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--global-limit" && hasValue) {
+            options.globalLimit = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    boost::asio::io_service ioService;
+    tcp::acceptor acceptor(ioService, tcp::endpoint(tcp::v4(), options.port));
+    RateLimiter limiter(options);
+    Storage storage;
+
+    std::clog << "Listening on http://localhost:" << options.port << '\n';
+
+    while (true) {
+        tcp::socket socket(ioService);
+        acceptor.accept(socket);
+        socket.set_option(tcp::no_delay(true));
+        std::thread(serveConnection, std::move(socket), std::cref(options), std::ref(limiter), std::ref(storage)).detach();
+    }
+}